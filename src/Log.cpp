@@ -3,12 +3,27 @@
 
 #include <cstdio>
 //#include <SDL2/SDL_log.h>
+#include <SDL2/SDL_mutex.h>
 
 namespace rob
 {
 namespace log
 {
 
+    /// The mutex is created on first use, so that logging works before and
+    /// without SDL_Init, and is never destroyed.
+    static SDL_mutex* GetMutex()
+    {
+        static SDL_mutex *mutex = ::SDL_CreateMutex();
+        return mutex;
+    }
+
+    LockGuard::LockGuard()
+    { ::SDL_LockMutex(GetMutex()); }
+
+    LockGuard::~LockGuard()
+    { ::SDL_UnlockMutex(GetMutex()); }
+
     void PrintValue(char value)
     { ::printf("%c", value); }
 
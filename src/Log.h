@@ -7,6 +7,17 @@ namespace rob
 namespace log
 {
 
+    /// Keeps the lines logged by concurrent threads from interleaving.
+    class LockGuard
+    {
+    public:
+        LockGuard();
+        ~LockGuard();
+
+        LockGuard(const LockGuard&) = delete;
+        LockGuard& operator = (const LockGuard&) = delete;
+    };
+
     void PrintValue(char value);
     void PrintValue(signed char value);
     void PrintValue(unsigned char value);
@@ -46,6 +57,7 @@ namespace log
     void Trace(Args&& ...args)
     {
     #ifdef ROB_TRACE
+        LockGuard lock;
         PrintValue("Trace: ");
         Print(args...);
         PrintValue('\n');
@@ -56,6 +68,7 @@ namespace log
     void Debug(Args&& ...args)
     {
     #ifdef ROB_DEBUG
+        LockGuard lock;
         PrintValue("Debug: ");
         Print(args...);
         PrintValue('\n');
@@ -65,6 +78,7 @@ namespace log
     template <class... Args>
     void Info(Args&& ...args)
     {
+        LockGuard lock;
         PrintValue("Info: ");
         Print(args...);
         PrintValue('\n');
@@ -73,6 +87,7 @@ namespace log
     template <class... Args>
     void Warning(Args&& ...args)
     {
+        LockGuard lock;
         PrintValue("Warning: ");
         Print(args...);
         PrintValue('\n');
@@ -81,6 +96,7 @@ namespace log
     template <class... Args>
     void Error(Args&& ...args)
     {
+        LockGuard lock;
         PrintValue("Error: ");
         Print(args...);
         PrintValue('\n');
@@ -7,17 +7,98 @@
 #include "../resource/MasterCache.h"
 #include "../renderer/Renderer.h"
 
+#include "../Assert.h"
 #include "../Log.h"
 
 #include <SDL2/SDL.h>
 
+#include <cstdlib>
+#include <cstring>
+
 namespace rob
 {
 
-    static const size_t_32 STATIC_MEMORY_SIZE = 4 * 1024 * 1024;
+    // The allocators reserve address space and commit memory as they grow.
+    static const size_t_32 STATIC_MEMORY_RESERVE = 64 * 1024 * 1024;
+    static const size_t_32 STATIC_MEMORY_COMMIT = 4 * 1024 * 1024;
+    static const size_t_32 STATE_MEMORY_RESERVE = 256 * 1024 * 1024;
+    // Heap memory used instead, if the address space cannot be reserved.
+    static const size_t_32 STATIC_MEMORY_FALLBACK = STATIC_MEMORY_COMMIT;
+    static const size_t_32 STATE_MEMORY_FALLBACK = 16 * 1024 * 1024;
+    // Memory for the transient per-frame allocations, split between two frames.
+    static const size_t_32 FRAME_MEMORY_SIZE = 256 * 1024;
+    // The allocator usage report is written to this file on F12.
+    static const char * const MEMORY_REPORT_FILE = "memory_report.txt";
+    // Time in microseconds used per frame for uploading the resources loaded
+    // in the background.
+    static const Time_t RESOURCE_UPLOAD_BUDGET = 2000;
+    // Fixed simulation steps per second, unless set by the game or ROB_STEP_RATE.
+    static const uint32_t DEFAULT_STEP_RATE = 60;
+
+    /// Selects the audio output by the ROB_AUDIO environment variable:
+    /// openal (default), sdl, wav or null.
+    static AudioConfig GetAudioConfig()
+    {
+        AudioConfig config;
+        const char *output = ::SDL_getenv("ROB_AUDIO");
+        if (!output)
+            return config;
+
+        if (std::strcmp(output, "sdl") == 0)
+            config.m_output = AudioOutput::SdlMixer;
+        else if (std::strcmp(output, "wav") == 0)
+            config.m_output = AudioOutput::WavFile;
+        else if (std::strcmp(output, "null") == 0)
+            config.m_output = AudioOutput::Null;
+        else if (std::strcmp(output, "openal") != 0)
+            log::Warning("Unknown ROB_AUDIO output: ", output);
+        return config;
+    }
+
+    /// Reads the simulation step rate from the ROB_STEP_RATE environment
+    /// variable.
+    static uint32_t GetStepRateConfig()
+    {
+        const char *rate = ::SDL_getenv("ROB_STEP_RATE");
+        if (!rate)
+            return DEFAULT_STEP_RATE;
+
+        const unsigned long stepsPerSecond = std::strtoul(rate, nullptr, 10);
+        if (stepsPerSecond == 0 || stepsPerSecond > 1000)
+        {
+            log::Warning("Invalid ROB_STEP_RATE: ", rate);
+            return DEFAULT_STEP_RATE;
+        }
+        return uint32_t(stepsPerSecond);
+    }
+
+    /// The static memory holds the frame and vertex buffers, so it is
+    /// committed and touched up front. Large pages are used, if the
+    /// ROB_LARGE_PAGES environment variable is set to 1.
+    static VirtualMemoryOptions GetStaticMemoryOptions()
+    {
+        VirtualMemoryOptions options;
+        options.m_initialCommit = STATIC_MEMORY_COMMIT;
+        options.m_prefault = true;
+        const char *largePages = ::SDL_getenv("ROB_LARGE_PAGES");
+        options.m_largePages = largePages && std::strcmp(largePages, "1") == 0;
+        return options;
+    }
+
+    /// Reserves the memory of the allocator, or falls back to a smaller
+    /// heap allocation. Returns false, if neither succeeds.
+    static bool ReserveMemory(LinearAllocator &alloc, const char *name, size_t_32 reserve,
+                              size_t_32 fallback, const VirtualMemoryOptions &options)
+    {
+        if (alloc.Reserve(reserve, options))
+            return true;
+        log::Warning(name, " memory: could not reserve ", reserve, " B, using ",
+                     fallback, " B from the heap");
+        return alloc.AllocateMemory(fallback);
+    }
 
     Game::Game()
-        : m_staticAlloc(STATIC_MEMORY_SIZE)
+        : m_staticAlloc()
         , m_window(nullptr)
         , m_graphics(nullptr)
         , m_audio(nullptr)
@@ -25,25 +106,44 @@ namespace rob
         , m_renderer(nullptr)
         , m_state(nullptr)
         , m_stateAlloc()
+        , m_frameAlloc()
+        , m_pacer()
+        , m_stepRate(GetStepRateConfig())
+        , m_hasMemory(false)
     {
         ::SDL_Init(SDL_INIT_EVERYTHING);
 
+        m_staticAlloc.SetName("Static", MemoryTag::Game);
+        m_stateAlloc.SetName("State", MemoryTag::State);
+        m_frameAlloc.SetName("Frame", MemoryTag::Frame);
+
+        m_hasMemory = ReserveMemory(m_staticAlloc, "Static", STATIC_MEMORY_RESERVE,
+                                    STATIC_MEMORY_FALLBACK, GetStaticMemoryOptions())
+                   && ReserveMemory(m_stateAlloc, "State", STATE_MEMORY_RESERVE,
+                                    STATE_MEMORY_FALLBACK, VirtualMemoryOptions());
+        // Setup reports the failure and the game does not run.
+        if (!m_hasMemory)
+            return;
+
         m_window = m_staticAlloc.new_object<Window>();
         m_graphics = m_staticAlloc.new_object<Graphics>(m_staticAlloc);
-        m_audio = m_staticAlloc.new_object<AudioSystem>(m_staticAlloc);
+        m_audio = m_staticAlloc.new_object<AudioSystem>(m_staticAlloc, GetAudioConfig());
         m_cache = m_staticAlloc.new_object<MasterCache>(m_graphics, m_audio, m_staticAlloc);
         m_renderer = m_staticAlloc.new_object<Renderer>(m_graphics, m_cache, m_staticAlloc);
 
+        m_frameAlloc.SetMemory(m_staticAlloc.Allocate(FRAME_MEMORY_SIZE, 16), FRAME_MEMORY_SIZE);
+
         log::Info("GL debug output: ", (m_graphics->HasDebugOutput()?"yes":"no"));
 
-        const size_t_32 freeMemory = STATIC_MEMORY_SIZE - m_staticAlloc.GetAllocatedSize();
-        log::Info("Static memory used: ", m_staticAlloc.GetAllocatedSize(), " B from ",
-                  STATIC_MEMORY_SIZE, " B total", " (", freeMemory ," B free)");
-        m_stateAlloc.SetMemory(m_staticAlloc.Allocate(freeMemory), freeMemory);
+        log::Info("Static memory used: ", m_staticAlloc.GetAllocatedSize(), " B, ",
+                  m_staticAlloc.GetCommittedSize(), " B committed from ",
+                  m_staticAlloc.GetTotalSize(), " B reserved");
     }
 
     Game::~Game()
     {
+        log::Info("Frame memory peak: ", m_frameAlloc.GetPeakSize(), " B from ",
+                  m_frameAlloc.GetFrameSize(), " B");
         m_stateAlloc.del_object(m_state);
         m_staticAlloc.del_object(m_renderer);
         m_staticAlloc.del_object(m_cache);
@@ -55,6 +155,12 @@ namespace rob
 
     bool Game::Setup()
     {
+        if (!m_hasMemory)
+        {
+            log::Error("Could not allocate the game memory, aborting...");
+            return false;
+        }
+
         if (!m_graphics->IsInitialized())
         {
             log::Error("Graphics was not initialized, aborting...");
@@ -76,13 +182,23 @@ namespace rob
         return true;
     }
 
+    void Game::SetStepRate(uint32_t stepsPerSecond)
+    {
+        ROB_ASSERT(stepsPerSecond > 0);
+        m_stepRate = stepsPerSecond;
+        if (m_state)
+            m_state->SetStepRate(stepsPerSecond);
+    }
+
     void Game::InitState()
     {
         m_state->SetAllocator(m_stateAlloc);
+        m_state->SetFrameAllocator(m_frameAlloc);
         m_state->SetAudio(m_audio);
         m_state->SetCache(m_cache);
         m_state->SetRenderer(m_renderer);
         m_state->SetWindow(m_window);
+        m_state->SetStepRate(m_stepRate);
         m_state->Initialize();
 
         int w, h;
@@ -97,15 +213,21 @@ namespace rob
 
         while (m_window->HandleEvents(this))
         {
+            m_frameAlloc.BeginFrame();
             m_graphics->Clear();
 
             m_audio->Update();
+            m_cache->Update(RESOURCE_UPLOAD_BUDGET);
 
             m_state->DoUpdate();
             m_state->DoRender();
+            m_renderer->FlushSprites();
 
             m_window->SwapBuffers();
 
+            m_pacer.SetIdle(m_state->IsIdle());
+            m_pacer.WaitForNextFrame();
+
             if (m_state->IsQuiting())
                 break;
 
@@ -144,7 +266,15 @@ namespace rob
     void Game::OnKeyPress(Keyboard::Key key, Keyboard::Scancode scancode, uint32_t mods)
     {
         if (key == Keyboard::Key::F12)
+        {
             ReportMemoryUsage(m_stateAlloc.GetAllocatedSize(), m_stateAlloc.GetTotalSize());
+            ReportAllocatorUsage(MEMORY_REPORT_FILE);
+        }
+        else if (key == Keyboard::Key::F11)
+        {
+            m_pacer.Report();
+            m_graphics->ReportSkippedCalls();
+        }
         m_state->OnKeyPress(key, scancode, mods);
     }
 
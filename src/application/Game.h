@@ -3,6 +3,8 @@
 #define H_ROB_GAME_H
 
 #include "../memory/LinearAllocator.h"
+#include "../memory/FrameAllocator.h"
+#include "../time/FramePacer.h"
 #include "../input/Keyboard.h"
 #include "../input/Mouse.h"
 
@@ -40,6 +42,9 @@ namespace rob
     protected:
         virtual void HandleStateChange(int state) { }
 
+        /// Sets the fixed simulation step rate of the current and the next states.
+        void SetStepRate(uint32_t stepsPerSecond);
+
         template <class State, class... Args>
         void ChangeState(Args&& ...args)
         {
@@ -63,6 +68,12 @@ namespace rob
 
         GameState *m_state;
         LinearAllocator m_stateAlloc;
+        FrameAllocator m_frameAlloc;
+
+        FramePacer m_pacer;
+        uint32_t m_stepRate;
+        /// False, if the allocators could not get their memory.
+        bool m_hasMemory;
     };
 
 } // rob
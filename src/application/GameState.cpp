@@ -6,16 +6,20 @@
 #include "../math/Projection.h"
 
 #include "../String.h"
-#include "../time/Time.h"
 
 namespace rob
 {
 
+    // Limits for the time simulated per frame, e.g. after a hitch.
+    static const Time_t MAX_FRAME_TIME = 250000;
+    static const uint32_t MAX_STEPS_PER_FRAME = 32;
+
     GameState::GameState()
         : m_ticker()
         , m_time(m_ticker)
         , m_gameTime()
         , m_alloc(nullptr)
+        , m_frameAlloc(nullptr)
         , m_cache(nullptr)
         , m_renderer(nullptr)
         , m_quit(false)
@@ -35,8 +39,8 @@ namespace rob
         const Time_t lastTime = m_time.GetTimeMicros();
         m_time.Update();
         Time_t frameTime = m_time.GetTimeMicros() - lastTime;
-        if (frameTime > 25000)
-            frameTime = 25000;
+        if (frameTime > MAX_FRAME_TIME)
+            frameTime = MAX_FRAME_TIME;
 
         static Time_t lastTicks = m_ticker.GetTicks();
         const Time_t ticks = m_ticker.GetTicks();
@@ -44,18 +48,24 @@ namespace rob
         lastTicks = ticks;
 
         m_gameTime.Update(frameTime);
+        uint32_t steps = 0;
         while (m_gameTime.Step())
         {
             m_time.Update();
             Update(m_gameTime);
+            // The simulation can not keep up, so the rest of the time is
+            // dropped instead of spiraling into ever longer updates.
+            if (++steps == MAX_STEPS_PER_FRAME)
+            {
+                m_gameTime.DropSteps();
+                break;
+            }
         }
+        PostUpdate();
     }
 
     void GameState::DoRender()
     {
-        if (m_time.IsPaused())
-            Delay(20);
-
         Render();
 
         const Time_t time = m_ticker.GetTicks(); // //m_time.GetTimeMicros();
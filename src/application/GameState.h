@@ -18,6 +18,7 @@ namespace rob
 
     class GameTime;
     class LinearAllocator;
+    class FrameAllocator;
     class AudioSystem;
     class MasterCache;
 //    class Renderer;
@@ -33,6 +34,9 @@ namespace rob
 
         void SetAllocator(LinearAllocator &alloc) { m_alloc = &alloc; }
         LinearAllocator& GetAllocator() { return *m_alloc; }
+        void SetFrameAllocator(FrameAllocator &alloc) { m_frameAlloc = &alloc; }
+        /// Allocations for transient data, valid until the end of the next frame.
+        FrameAllocator& GetFrameAllocator() { return *m_frameAlloc; }
 
         void SetAudio(AudioSystem *audio) { m_audio = audio; }
         AudioSystem& GetAudio() { return *m_audio; }
@@ -48,9 +52,15 @@ namespace rob
 
         const View& GetDefaultView() const { return m_defaultView; }
 
-        /// Gets called from Game. Handles fixed step update and calls virtual method Update.
+        /// Sets the fixed simulation step rate in steps per second.
+        void SetStepRate(uint32_t stepsPerSecond) { m_gameTime.SetStepRate(stepsPerSecond); }
+
+        /// Gets called from Game. Handles fixed step update and calls virtual
+        /// methods Update and PostUpdate.
         void DoUpdate();
-        /// Gets called from Game. Calls virtual method Render.
+        /// Gets called from Game. Calls virtual method Render. Render can use
+        /// GameTime::GetInterpolationAlpha to interpolate between the previous
+        /// and the current fixed step.
         void DoRender();
 
         void Resize(int w, int h);
@@ -60,10 +70,16 @@ namespace rob
 
         virtual void RealtimeUpdate(const Time_t deltaMicroseconds) { }
         virtual void Update(const GameTime &gameTime) { }
+        /// Called once a frame after the fixed steps of the frame.
+        virtual void PostUpdate() { }
         virtual void Render() { }
 
         virtual void OnResize(int w, int h) { }
 
+        /// Returns true, if the state does not need the full frame rate.
+        /// The frames are then paced at the idle rate of the FramePacer.
+        virtual bool IsIdle() const { return m_time.IsPaused(); }
+
 
         virtual void OnTextInput(const char *str) { }
 
@@ -89,6 +105,7 @@ namespace rob
 
     private:
         LinearAllocator *   m_alloc;
+        FrameAllocator *    m_frameAlloc;
         AudioSystem *       m_audio;
         MasterCache *       m_cache;
         Renderer *          m_renderer;
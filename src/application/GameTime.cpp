@@ -1,5 +1,6 @@
 
 #include "GameTime.h"
+#include "../Assert.h"
 
 namespace rob
 {
@@ -10,6 +11,12 @@ namespace rob
         , m_accumulator(0)
     { }
 
+    void GameTime::SetStepRate(uint32_t stepsPerSecond)
+    {
+        ROB_ASSERT(stepsPerSecond > 0);
+        m_deltaTime = 1000000ULL / stepsPerSecond;
+    }
+
     void GameTime::Update(const Time_t frameTime)
     {
         m_accumulator += frameTime;
@@ -17,7 +24,7 @@ namespace rob
 
     bool GameTime::Step()
     {
-        if (m_accumulator > m_deltaTime)
+        if (m_accumulator >= m_deltaTime)
         {
             m_accumulator -= m_deltaTime;
             m_time += m_deltaTime;
@@ -26,6 +33,11 @@ namespace rob
         return false;
     }
 
+    void GameTime::DropSteps()
+    {
+        m_accumulator %= m_deltaTime;
+    }
+
     Time_t GameTime::GetDeltaMicroseconds() const
     { return m_deltaTime; }
 
@@ -38,4 +50,7 @@ namespace rob
     double GameTime::GetTotalSeconds() const
     { return double(m_time) / 1000000.0; }
 
+    float GameTime::GetInterpolationAlpha() const
+    { return float(m_accumulator) / float(m_deltaTime); }
+
 } // rob
@@ -11,12 +11,23 @@ namespace rob
     {
     public:
         GameTime();
+
+        /// Sets the fixed simulation step rate in steps per second.
+        void SetStepRate(uint32_t stepsPerSecond);
+
         void Update(const Time_t frameTime);
         bool Step();
+        /// Drops the whole steps left in the accumulator.
+        void DropSteps();
         Time_t GetDeltaMicroseconds() const;
         double GetDeltaSeconds() const;
         Time_t GetTotalMicroseconds() const;
         double GetTotalSeconds() const;
+
+        /// Returns the fraction of a step left in the accumulator after
+        /// stepping, i.e. how far between the previous and the current
+        /// step the rendered frame is. The value is in range [0, 1).
+        float GetInterpolationAlpha() const;
     private:
         Time_t m_deltaTime;
         Time_t m_time;
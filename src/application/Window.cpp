@@ -68,6 +68,7 @@ namespace rob
 
         ROB_ASSERT(GLEW_VERSION_2_1);
 
+        // Frame rate is limited by the FramePacer of the Game.
         SDL_GL_SetSwapInterval(0);
     }
 
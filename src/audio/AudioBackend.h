@@ -0,0 +1,72 @@
+
+#ifndef H_ROB_AUDIO_BACKEND_H
+#define H_ROB_AUDIO_BACKEND_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    typedef unsigned int SoundHandle;
+    static const SoundHandle InvalidSound = ~0;
+
+    typedef unsigned int StreamHandle;
+    static const StreamHandle InvalidStream = ~0;
+
+    static const size_t_32 MAX_SOUNDS = 64;
+    static const size_t_32 MAX_CHANNELS = 16;
+    static const size_t_32 MAX_STREAMS = 2;
+
+    // The listener position; the sounds are on the z = 0 plane.
+    static const float LISTENER_Z = -2.0f;
+
+    /// Interleaved PCM samples of a sound. The samples are not owned.
+    struct WaveData
+    {
+        const uint8_t *m_samples;
+        uint32_t m_size;
+        uint16_t m_channels;
+        uint16_t m_bitsPerSample;
+        uint32_t m_frequency;
+    };
+
+    /// Plays the sounds on an audio device. The AudioSystem decides which
+    /// sound plays on which channel; the backend only drives the device.
+    /// Sounds are identified by their handle, channels and streams by index.
+    class AudioBackend
+    {
+    public:
+        virtual ~AudioBackend() { }
+
+        virtual const char* GetName() const = 0;
+
+        /// Returns true, if the backend can play samples of the format.
+        virtual bool IsFormatSupported(const WaveData &wave) const = 0;
+
+        /// Sets the samples of the sound. Returns false, if the format is not
+        /// supported. The backend may use the samples in place, so they must
+        /// stay valid until the sound is released.
+        virtual bool SetSoundData(SoundHandle sound, const WaveData &wave) = 0;
+        virtual void ReleaseSound(SoundHandle sound) = 0;
+
+        virtual void SetMasterGain(float gain) = 0;
+
+        /// Plays the sound at the position with the inverse distance clamped
+        /// attenuation relative to the listener.
+        virtual void PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y) = 0;
+        virtual void StopChannel(size_t_32 channel) = 0;
+        virtual bool IsChannelPlaying(size_t_32 channel) const = 0;
+
+        /// Streams are not positional and can loop.
+        virtual bool PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping) = 0;
+        virtual void StopStream(size_t_32 stream) = 0;
+        virtual void SetStreamGain(size_t_32 stream, float gain) = 0;
+        virtual bool IsStreamPlaying(size_t_32 stream) const = 0;
+
+        /// Called once a frame.
+        virtual void Update() = 0;
+    };
+
+} // rob
+
+#endif // H_ROB_AUDIO_BACKEND_H
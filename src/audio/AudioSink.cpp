@@ -0,0 +1,164 @@
+
+#include "AudioSink.h"
+#include "SoftwareMixer.h"
+
+#include "../Log.h"
+
+namespace rob
+{
+
+    // Number of frames the SDL device requests at a time, ~23 ms.
+    static const Uint16 SDL_BUFFER_FRAMES = 1024;
+    // Maximum time mixed at once by the null sink. Longer stalls are skipped.
+    static const uint32_t MAX_PUMP_FRAMES = SoftwareMixer::OUTPUT_FREQUENCY / 4;
+
+    SdlAudioSink::SdlAudioSink()
+        : m_device(0)
+    { }
+
+    SdlAudioSink::~SdlAudioSink()
+    {
+        if (m_device) ::SDL_CloseAudioDevice(m_device);
+    }
+
+    bool SdlAudioSink::Start(SoftwareMixer *mixer)
+    {
+        SDL_AudioSpec desired = { };
+        desired.freq = SoftwareMixer::OUTPUT_FREQUENCY;
+        desired.format = AUDIO_S16SYS;
+        desired.channels = SoftwareMixer::OUTPUT_CHANNELS;
+        desired.samples = SDL_BUFFER_FRAMES;
+        desired.callback = &SdlAudioSink::AudioCallback;
+        desired.userdata = mixer;
+
+        // SDL converts the output, if the device does not support the format.
+        m_device = ::SDL_OpenAudioDevice(nullptr, 0, &desired, nullptr, 0);
+        if (m_device == 0)
+        {
+            log::Error("Could not open SDL audio device: ", ::SDL_GetError());
+            return false;
+        }
+        ::SDL_PauseAudioDevice(m_device, 0);
+        return true;
+    }
+
+    void SdlAudioSink::Lock()
+    { ::SDL_LockAudioDevice(m_device); }
+
+    void SdlAudioSink::Unlock()
+    { ::SDL_UnlockAudioDevice(m_device); }
+
+    void SdlAudioSink::AudioCallback(void *userData, Uint8 *stream, int len)
+    {
+        SoftwareMixer *mixer = static_cast<SoftwareMixer*>(userData);
+        const uint32_t frameSize = SoftwareMixer::OUTPUT_CHANNELS * sizeof(int16_t);
+        mixer->Mix(reinterpret_cast<int16_t*>(stream), uint32_t(len) / frameSize);
+    }
+
+
+    NullAudioSink::NullAudioSink()
+        : m_mixer(nullptr)
+        , m_ticker()
+        , m_framesMixed(0)
+    { }
+
+    bool NullAudioSink::Start(SoftwareMixer *mixer)
+    {
+        m_mixer = mixer;
+        m_ticker.Init();
+        m_framesMixed = 0;
+        return true;
+    }
+
+    void NullAudioSink::Pump()
+    {
+        const uint64_t frames = uint64_t(m_ticker.GetTicks()) * SoftwareMixer::OUTPUT_FREQUENCY / 1000000ull;
+        if (frames - m_framesMixed > MAX_PUMP_FRAMES)
+            m_framesMixed = frames - MAX_PUMP_FRAMES;
+
+        int16_t block[SoftwareMixer::MIX_BLOCK_FRAMES * SoftwareMixer::OUTPUT_CHANNELS];
+        while (m_framesMixed < frames)
+        {
+            uint32_t count = uint32_t(frames - m_framesMixed);
+            if (count > SoftwareMixer::MIX_BLOCK_FRAMES)
+                count = SoftwareMixer::MIX_BLOCK_FRAMES;
+            m_mixer->Mix(block, count);
+            Write(block, count);
+            m_framesMixed += count;
+        }
+    }
+
+    void NullAudioSink::Write(const int16_t * /*frames*/, uint32_t /*frameCount*/)
+    { }
+
+
+    struct WavHeader
+    {
+        char riff[4];
+        uint32_t riffSize;
+        char wave[4];
+        char fmt[4];
+        uint32_t fmtSize;
+        uint16_t format;
+        uint16_t channels;
+        uint32_t frequency;
+        uint32_t byteRate;
+        uint16_t blockAlign;
+        uint16_t bitsPerSample;
+        char data[4];
+        uint32_t dataSize;
+    };
+
+    WavFileAudioSink::WavFileAudioSink(const char *filename)
+        : m_filename(filename)
+        , m_file(nullptr)
+        , m_dataSize(0)
+    { }
+
+    WavFileAudioSink::~WavFileAudioSink()
+    {
+        if (!m_file) return;
+        // Fill in the sizes now that they are known.
+        std::fseek(m_file, 0, SEEK_SET);
+        WriteHeader(m_dataSize);
+        fs::Close(m_file);
+    }
+
+    bool WavFileAudioSink::Start(SoftwareMixer *mixer)
+    {
+        m_file = fs::OpenToWrite(m_filename);
+        if (!m_file)
+        {
+            log::Error("Could not open ", m_filename, " for writing audio");
+            return false;
+        }
+        WriteHeader(0);
+        return NullAudioSink::Start(mixer);
+    }
+
+    void WavFileAudioSink::WriteHeader(uint32_t dataSize)
+    {
+        const uint16_t frameSize = SoftwareMixer::OUTPUT_CHANNELS * sizeof(int16_t);
+        WavHeader header = {
+            {'R', 'I', 'F', 'F'}, uint32_t(sizeof(WavHeader) - 8 + dataSize),
+            {'W', 'A', 'V', 'E'},
+            {'f', 'm', 't', ' '}, 16,
+            1, // PCM
+            SoftwareMixer::OUTPUT_CHANNELS,
+            SoftwareMixer::OUTPUT_FREQUENCY,
+            SoftwareMixer::OUTPUT_FREQUENCY * frameSize,
+            frameSize,
+            16,
+            {'d', 'a', 't', 'a'}, dataSize
+        };
+        fs::Write(m_file, header);
+    }
+
+    void WavFileAudioSink::Write(const int16_t *frames, uint32_t frameCount)
+    {
+        const uint32_t size = frameCount * SoftwareMixer::OUTPUT_CHANNELS * sizeof(int16_t);
+        fs::Write(m_file, reinterpret_cast<const char*>(frames), size);
+        m_dataSize += size;
+    }
+
+} // rob
@@ -0,0 +1,101 @@
+
+#ifndef H_ROB_AUDIO_SINK_H
+#define H_ROB_AUDIO_SINK_H
+
+#include "../filesystem/FileSystem.h"
+#include "../time/MicroTicker.h"
+
+#include <SDL2/SDL.h>
+
+namespace rob
+{
+
+    class SoftwareMixer;
+
+    /// Output of the SoftwareMixer.
+    class AudioSink
+    {
+    public:
+        virtual ~AudioSink() { }
+
+        virtual const char* GetName() const = 0;
+
+        /// Starts pulling the output of the mixer. Returns false, if the
+        /// output could not be opened.
+        virtual bool Start(SoftwareMixer *mixer) = 0;
+
+        /// Called once a frame from the main thread.
+        virtual void Pump() { }
+
+        /// Excludes the mixing while the mixer state is changed.
+        virtual void Lock() { }
+        virtual void Unlock() { }
+    };
+
+    /// Plays the output through an SDL audio device. The device mixes in
+    /// its own thread.
+    class SdlAudioSink : public AudioSink
+    {
+    public:
+        SdlAudioSink();
+        ~SdlAudioSink();
+
+        const char* GetName() const override { return "SDL audio"; }
+        bool Start(SoftwareMixer *mixer) override;
+        void Lock() override;
+        void Unlock() override;
+
+    private:
+        static void AudioCallback(void *userData, Uint8 *stream, int len);
+
+    private:
+        SDL_AudioDeviceID m_device;
+    };
+
+    /// Mixes the output in Pump by the elapsed real time, so that the sounds
+    /// play at the right speed without an audio device.
+    class NullAudioSink : public AudioSink
+    {
+    public:
+        NullAudioSink();
+
+        const char* GetName() const override { return "Null"; }
+        bool Start(SoftwareMixer *mixer) override;
+        void Pump() override;
+
+    protected:
+        /// Receives the mixed output frames.
+        virtual void Write(const int16_t *frames, uint32_t frameCount);
+
+    private:
+        SoftwareMixer *m_mixer;
+        MicroTicker m_ticker;
+        uint64_t m_framesMixed;
+    };
+
+    /// Writes the output to a 16-bit stereo .wav file. Useful for checking
+    /// the audio on hosts without an audio device.
+    class WavFileAudioSink : public NullAudioSink
+    {
+    public:
+        explicit WavFileAudioSink(const char *filename);
+        ~WavFileAudioSink();
+
+        const char* GetName() const override { return "WAV file"; }
+        bool Start(SoftwareMixer *mixer) override;
+
+    protected:
+        void Write(const int16_t *frames, uint32_t frameCount) override;
+
+    private:
+        void WriteHeader(uint32_t dataSize);
+
+    private:
+        const char *m_filename;
+        fs::File m_file;
+        uint32_t m_dataSize;
+    };
+
+} // rob
+
+#endif // H_ROB_AUDIO_SINK_H
@@ -1,209 +1,160 @@
 
 #include "AudioSystem.h"
-#include "ALCheck.h"
+#include "AudioSink.h"
+#include "AudioThread.h"
+#include "OpenALBackend.h"
+#include "SoftwareMixer.h"
 
 #include "../memory/LinearAllocator.h"
 
+#include "../Assert.h"
 #include "../Log.h"
 
-#include <AL/al.h>
-#include <SDL2/SDL_audio.h>
+#include <cmath>
 
 namespace rob
 {
 
+    // Sounds quieter than this are not played. The sounds of the game are at
+    // most about four units from the listener, so mostly the sounds played at
+    // a low volume or with a low master volume are culled.
+    static const float MIN_AUDIBILITY = 0.01f;
+    // Interval of polling the channels for stopped sounds in microseconds.
+    static const Time_t CHANNEL_POLL_INTERVAL = 50000;
+
     struct Sound
     {
-        ALuint buffer;
+        uint32_t durationMillis;
+        int priority;
 
         Sound()
         {
-            buffer = 0;
-            alGenBuffers(1, &buffer);
-            AL_CHECK;
-        }
-
-        ~Sound()
-        {
-            alDeleteBuffers(1, &buffer);
-            AL_CHECK;
+            durationMillis = 0;
+            priority = SOUND_PRIORITY_NORMAL;
         }
     };
 
-    struct Channel
+    /// Returns the audibility weighted by the part of the sound left to play,
+    /// as cutting off the end of a sound is less noticeable.
+    float AudioSystem::Channel::GetAudibility(uint32_t currentTime) const
     {
-        ALuint source;
-        Sound *playingSound;
-        uint32_t startTime;
-
-        Channel()
-        {
-            source = 0;
-            alGenSources(1, &source);
-            AL_CHECK;
-            playingSound = nullptr;
-            startTime = 0;
-        }
-
-        void PlaySound(Sound *sound, float volume, float x, float y, uint32_t currentTime)
-        {
-            playingSound = sound;
-            startTime = currentTime;
-
-            alSourcef(source, AL_PITCH, 1.0f);
-            AL_CHECK;
-            alSourcef(source, AL_GAIN, volume);
-            AL_CHECK;
-            alSource3f(source, AL_POSITION, x, y, 0.0f);
-            AL_CHECK;
-            alSource3f(source, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
-            AL_CHECK;
-            alSourcei(source, AL_LOOPING, AL_FALSE);
-            AL_CHECK;
-            alSourcef(source, AL_MIN_GAIN, volume);
-            AL_CHECK;
-
-//            alSourceQueueBuffers(source, 1, &sound->buffer);
-            alSourcei(source, AL_BUFFER, sound->buffer);
-            AL_CHECK;
-
-            alSourcePlay(source);
-            AL_CHECK;
-        }
-
-        void Stop()
-        { alSourceStop(source); }
-
-        void Update()
-        {
-            if (playingSound == nullptr) return;
-
-//            ALint processed = 0;
-//            alGetSourceiv(source, AL_BUFFERS_PROCESSED, &processed);
-            ALint state = 0;
-            alGetSourcei(source, AL_SOURCE_STATE, &state);
-            AL_CHECK;
-
-//            if (processed > 0)
-            if (state == AL_STOPPED)
-            {
-//                ALuint buffer = 0;
-//                alSourceUnqueueBuffers(source, 1, &buffer);
-                alSourcei(source, AL_BUFFER, 0);
-                AL_CHECK;
-
-                playingSound = nullptr;
-            }
-        }
-
-        bool IsFree() const
-        { return playingSound == nullptr; }
-
-        uint32_t TimePlayed(uint32_t currentTime)
-        { return currentTime - startTime; }
-    };
+        const uint32_t duration = playingSound->durationMillis;
+        const uint32_t played = currentTime - startTime;
+        if (duration == 0 || played >= duration)
+            return 0.0f;
+        return audibility * float(duration - played) / float(duration);
+    }
 
-    AudioSystem::AudioSystem(LinearAllocator& alloc)
-        : m_device(nullptr)
-        , m_context(nullptr)
+    AudioSystem::AudioSystem(LinearAllocator& alloc, const AudioConfig &config)
+        : m_alloc(alloc)
+        , m_backend(nullptr)
+        , m_sink(nullptr)
+        , m_thread(nullptr)
         , m_sounds()
-        , m_channelPool()
         , m_channels()
+        , m_freeChannels()
+        , m_freeCount(0)
+        , m_activeChannels()
+        , m_activeCount(0)
+        , m_ticker()
+        , m_lastPoll(0)
         , m_masterVolume(1.0f)
         , m_muted(false)
     {
-        m_device = alcOpenDevice(nullptr);
-        AL_CHECK;
-
-        if (m_device == nullptr)
+        if (!CreateBackend(config))
         {
-            log::Error("Could not open audio device.");
-            return;
-        }
-
-        m_context = alcCreateContext(m_device, nullptr);
-        AL_CHECK;
-
-        if (m_context == nullptr)
-        {
-            log::Error("Could not create audio context.");
-            return;
+            AudioConfig fallback;
+            fallback.m_output = AudioOutput::SdlMixer;
+            if (config.m_output == AudioOutput::SdlMixer || !CreateBackend(fallback))
+            {
+                fallback.m_output = AudioOutput::Null;
+                CreateBackend(fallback);
+            }
         }
+        log::Info("Audio output: ", m_backend->GetName(), (m_sink ? " / " : ""),
+                  (m_sink ? m_sink->GetName() : ""));
 
-        alcMakeContextCurrent(m_context);
-        AL_CHECK;
+        // The backend is used only from the audio thread from here on.
+        m_thread = m_alloc.new_object<AudioThread>(*m_backend);
 
-        const size_t_32 allocSize = 1024;
-        m_sounds.SetMemory(alloc.Allocate(allocSize, alignof(Sound)), allocSize);
-        const size_t_32 channelPoolSize = GetArraySize<Channel>(MAX_CHANNELS);
-        m_channelPool.SetMemory(alloc.AllocateArray<Channel>(MAX_CHANNELS), channelPoolSize);
+        m_sounds.SetName("Sounds", MemoryTag::Audio);
+        const size_t_32 soundPoolSize = GetArraySize<Sound>(MAX_SOUNDS);
+        m_sounds.SetMemory(alloc.AllocateArray<Sound>(MAX_SOUNDS), soundPoolSize);
 
         for (size_t_32 i = 0; i < MAX_CHANNELS; i++)
         {
-            m_channels[i] = m_channelPool.Obtain();
+            m_freeChannels[m_freeCount++] = MAX_CHANNELS - 1 - i;
         }
 
+        m_ticker.Init();
+
         SetMasterVolume(m_masterVolume);
-        alListener3f(AL_POSITION, 0.0f, 0.0f, -2.0f);
-        AL_CHECK;
     }
 
     AudioSystem::~AudioSystem()
     {
-        for (size_t_32 i = 0; i < MAX_CHANNELS; i++)
-        {
-            m_channelPool.Return(m_channels[i]);
-        }
-
-        if (m_context) alcDestroyContext(m_context);
-        if (m_device) alcCloseDevice(m_device);
+        m_alloc.del_object(m_thread);
+        m_alloc.del_object(m_sink);
+        m_alloc.del_object(m_backend);
     }
 
-    ALenum GetALFormat(const SDL_AudioSpec &spec)
+    bool AudioSystem::CreateBackend(const AudioConfig &config)
     {
-        int bits = SDL_AUDIO_BITSIZE(spec.format);
-        int chan = spec.channels;
-        if (bits == 8)
-        {
-            if (chan == 1) return AL_FORMAT_MONO8;
-            if (chan == 2) return AL_FORMAT_STEREO8;
-        }
-        else if (bits == 16)
+        if (config.m_output == AudioOutput::OpenAL)
         {
-            if (chan == 1) return AL_FORMAT_MONO16;
-            if (chan == 2) return AL_FORMAT_STEREO16;
+            OpenALBackend *openAL = m_alloc.new_object<OpenALBackend>();
+            m_backend = openAL;
+            if (openAL->Init())
+                return true;
+            m_alloc.del_object(openAL);
+            m_backend = nullptr;
+            return false;
         }
-        return 0;
-    }
-
-    SoundHandle AudioSystem::LoadSound(const char * const filename)
-    {
-        SDL_AudioSpec spec;
-        Uint32 len;
-        Uint8 *wav;
 
-        if (SDL_LoadWAV(filename, &spec, &wav, &len) == nullptr)
+        AudioSink *sink = nullptr;
+        switch (config.m_output)
         {
-            log::Error("Could not load sound ", filename, ": ", SDL_GetError());
-            return InvalidSound;
+        case AudioOutput::SdlMixer:
+            sink = m_alloc.new_object<SdlAudioSink>();
+            break;
+        case AudioOutput::WavFile:
+            sink = m_alloc.new_object<WavFileAudioSink>(config.m_wavFile);
+            break;
+        default:
+            sink = m_alloc.new_object<NullAudioSink>();
+            break;
         }
 
-        ALenum format = GetALFormat(spec);
-        if (format == 0)
+        // The memory of a failed backend is not reclaimed from the linear
+        // allocator, but this happens at most a couple of times at startup.
+        SoftwareMixer *mixer = m_alloc.new_object<SoftwareMixer>();
+        if (!sink->Start(mixer))
         {
-            log::Error("Could not load sound ", filename, ": Unsupported data format");
-            SDL_FreeWAV(wav);
-            return InvalidSound;
+            m_alloc.del_object(sink);
+            m_alloc.del_object(mixer);
+            return false;
         }
+        mixer->SetSink(sink);
+        m_backend = mixer;
+        m_sink = sink;
+        return true;
+    }
 
+    SoundHandle AudioSystem::CreateSound()
+    {
         Sound *sound = m_sounds.Obtain();
+        return m_sounds.IndexOf(sound);
+    }
 
-        alBufferData(sound->buffer, format, wav, len, spec.freq);
-        AL_CHECK;
-
-        SDL_FreeWAV(wav);
+    bool AudioSystem::SetSoundData(SoundHandle sound, const WaveData &wave)
+    {
+        if (!m_thread->SetSoundData(sound, wave))
+            return false;
 
-        return m_sounds.IndexOf(sound);
+        Sound *s = m_sounds.Get(sound);
+        const uint32_t frameSize = wave.m_channels * wave.m_bitsPerSample / 8;
+        s->durationMillis = uint64_t(wave.m_size / frameSize) * 1000 / wave.m_frequency;
+        return true;
     }
 
     void AudioSystem::UnloadSound(SoundHandle sound)
@@ -211,9 +162,24 @@ namespace rob
         if (sound == InvalidSound) return;
 
         Sound *s = m_sounds.Get(sound);
+        // The sound data cannot be released while a channel uses it.
+        for (size_t_32 i = 0; i < m_activeCount; )
+        {
+            if (m_channels[m_activeChannels[i]].playingSound == s)
+                FreeChannel(i);
+            else
+                i++;
+        }
+        m_thread->ReleaseSound(sound);
         m_sounds.Return(s);
     }
 
+    void AudioSystem::SetSoundPriority(SoundHandle sound, int priority)
+    {
+        if (sound == InvalidSound) return;
+        m_sounds.Get(sound)->priority = priority;
+    }
+
     void AudioSystem::SetMute(bool mute)
     { m_muted = mute; }
 
@@ -226,8 +192,37 @@ namespace rob
     void AudioSystem::SetMasterVolume(float volume)
     {
         m_masterVolume = volume;
-        alListenerf(AL_GAIN, volume);
-        AL_CHECK;
+        m_thread->SetMasterGain(volume);
+    }
+
+    float AudioSystem::GetAudibility(float volume, float x, float y) const
+    {
+        // Inverse distance clamped with the default reference distance and
+        // rolloff factor of 1.
+        const float dz = LISTENER_Z;
+        const float distance = std::sqrt(x * x + y * y + dz * dz);
+        return volume * m_masterVolume / (distance > 1.0f ? distance : 1.0f);
+    }
+
+    size_t_32 AudioSystem::FindChannelToSteal(uint32_t timeMillis) const
+    {
+        size_t_32 victim = 0;
+        int victimPriority = 0;
+        float victimAudibility = 0.0f;
+        for (size_t_32 i = 0; i < m_activeCount; i++)
+        {
+            const Channel &channel = m_channels[m_activeChannels[i]];
+            const int priority = channel.playingSound->priority;
+            const float audibility = channel.GetAudibility(timeMillis);
+            if (i == 0 || priority < victimPriority
+                || (priority == victimPriority && audibility < victimAudibility))
+            {
+                victim = i;
+                victimPriority = priority;
+                victimAudibility = audibility;
+            }
+        }
+        return victim;
     }
 
     void AudioSystem::PlaySound(SoundHandle sound, float volume, float x, float y, Time_t currentTime)
@@ -235,40 +230,119 @@ namespace rob
         if (IsMuted()) return;
         if (sound == InvalidSound) return;
 
-        uint32_t timeMillis = currentTime / 1000ull;
+        const float audibility = GetAudibility(volume, x, y);
+        if (audibility < MIN_AUDIBILITY)
+            return;
+
+        const uint32_t timeMillis = currentTime / 1000ull;
+        Sound *s = m_sounds.Get(sound);
 
-        size_t_32 longestPlayIndex = 0;
-        uint32_t longestPlayTime = 0;
+        // Some of the channels may have stopped since the last poll.
+        if (m_freeCount == 0)
+            PollChannels();
 
-        for (size_t_32 i = 0; i < MAX_CHANNELS; i++)
+        size_t_32 channel;
+        if (m_freeCount > 0)
         {
-            if (m_channels[i]->IsFree())
+            channel = m_freeChannels[--m_freeCount];
+            m_activeChannels[m_activeCount++] = channel;
+        }
+        else
+        {
+            const size_t_32 victim = FindChannelToSteal(timeMillis);
+            channel = m_activeChannels[victim];
+            const Channel &playing = m_channels[channel];
+            const int priority = playing.playingSound->priority;
+            if (priority > s->priority
+                || (priority == s->priority && playing.GetAudibility(timeMillis) > audibility))
             {
-                Sound *s = m_sounds.Get(sound);
-                m_channels[i]->PlaySound(s, volume, x, y, timeMillis);
                 return;
             }
+            m_thread->StopChannel(channel);
+        }
+
+        Channel &ch = m_channels[channel];
+        ch.playingSound = s;
+        ch.startTime = timeMillis;
+        ch.audibility = audibility;
+        m_thread->PlayChannel(channel, sound, volume, x, y);
+    }
+
+    size_t_32 AudioSystem::GetPlayingCount(SoundHandle sound) const
+    {
+        if (sound == InvalidSound) return 0;
+        const Sound *s = m_sounds.Get(sound);
+        size_t_32 count = 0;
+        for (size_t_32 i = 0; i < m_activeCount; i++)
+        {
+            if (m_channels[m_activeChannels[i]].playingSound == s)
+                count++;
+        }
+        return count;
+    }
 
-            uint32_t playTime = m_channels[i]->TimePlayed(timeMillis);
+    void AudioSystem::FreeChannel(size_t_32 activeIndex)
+    {
+        const uint8_t channel = m_activeChannels[activeIndex];
+        m_thread->StopChannel(channel);
+        m_channels[channel].playingSound = nullptr;
+        m_activeChannels[activeIndex] = m_activeChannels[--m_activeCount];
+        m_freeChannels[m_freeCount++] = channel;
+    }
 
-            if (playTime > longestPlayTime)
+    void AudioSystem::PollChannels()
+    {
+        for (size_t_32 i = 0; i < m_activeCount; )
+        {
+            if (!m_thread->IsChannelPlaying(m_activeChannels[i]))
+                FreeChannel(i);
+            else
+                i++;
+        }
+        m_lastPoll = m_ticker.GetTicks();
+    }
+
+    StreamHandle AudioSystem::PlayStream(const WaveData &wave, float volume, bool looping)
+    {
+        for (size_t_32 i = 0; i < MAX_STREAMS; i++)
+        {
+            if (!m_thread->IsStreamPlaying(i))
             {
-                longestPlayIndex = i;
-                longestPlayTime = playTime;
+                if (!m_thread->PlayStream(i, wave, volume, looping))
+                    return InvalidStream;
+                return i;
             }
         }
+        log::Error("All ", MAX_STREAMS, " streams are playing");
+        return InvalidStream;
+    }
 
-        Sound *s = m_sounds.Get(sound);
-        m_channels[longestPlayIndex]->Stop();
-        m_channels[longestPlayIndex]->PlaySound(s, volume, x, y, timeMillis);
+    void AudioSystem::StopStream(StreamHandle stream)
+    {
+        if (stream == InvalidStream) return;
+        ROB_ASSERT(stream < MAX_STREAMS);
+        m_thread->StopStream(stream);
+    }
+
+    void AudioSystem::SetStreamVolume(StreamHandle stream, float volume)
+    {
+        if (stream == InvalidStream) return;
+        ROB_ASSERT(stream < MAX_STREAMS);
+        m_thread->SetStreamGain(stream, volume);
+    }
+
+    bool AudioSystem::IsStreamPlaying(StreamHandle stream) const
+    {
+        if (stream == InvalidStream) return false;
+        ROB_ASSERT(stream < MAX_STREAMS);
+        return m_thread->IsStreamPlaying(stream);
     }
 
     void AudioSystem::Update()
     {
-        for (size_t_32 i = 0; i < MAX_CHANNELS; i++)
-        {
-            m_channels[i]->Update();
-        }
+        if (m_ticker.GetTicks() - m_lastPoll >= CHANNEL_POLL_INTERVAL)
+            PollChannels();
+        m_thread->Update();
     }
 
 } // rob
@@ -2,48 +2,127 @@
 #ifndef H_ROB_AUDIO_SYSTEM_H
 #define H_ROB_AUDIO_SYSTEM_H
 
-#include "../memory/Pool.h"
+#include "AudioBackend.h"
 
-#include <AL/alc.h>
+#include "../memory/Pool.h"
+#include "../time/MicroTicker.h"
 
 namespace rob
 {
 
     class LinearAllocator;
 
+    class AudioSink;
+    class AudioThread;
     struct Sound;
-    struct Channel;
 
-    typedef unsigned int SoundHandle;
-    static const SoundHandle InvalidSound = ~0;
+    static const int SOUND_PRIORITY_LOW = 0;
+    static const int SOUND_PRIORITY_NORMAL = 1;
+    static const int SOUND_PRIORITY_HIGH = 2;
+
+    enum class AudioOutput
+    {
+        /// OpenAL device.
+        OpenAL,
+        /// Software mixer playing through an SDL audio device.
+        SdlMixer,
+        /// Software mixer writing the output to a .wav file.
+        WavFile,
+        /// Software mixer discarding the output.
+        Null
+    };
 
-    static const size_t_32 MAX_CHANNELS = 16;
+    struct AudioConfig
+    {
+        AudioOutput m_output = AudioOutput::OpenAL;
+        /// The file written by AudioOutput::WavFile.
+        const char *m_wavFile = "audio_out.wav";
+    };
 
+    /// Decides which sounds are played on which channels. The backend is
+    /// driven by a dedicated audio thread, so the calls only queue commands
+    /// for it and do not block on the device.
     class AudioSystem
     {
     public:
-        AudioSystem(LinearAllocator &alloc);
+        /// Falls back to the software mixer, if the output cannot be opened,
+        /// and finally to the null output.
+        AudioSystem(LinearAllocator &alloc, const AudioConfig &config = AudioConfig());
+        AudioSystem(const AudioSystem&) = delete;
+        AudioSystem& operator = (const AudioSystem&) = delete;
         ~AudioSystem();
 
-        SoundHandle LoadSound(const char * const filename);
+        const char* GetBackendName() const { return m_backend->GetName(); }
+
+        /// Creates a sound without data.
+        SoundHandle CreateSound();
+        /// Sets the samples of the sound. The samples must stay valid until
+        /// the sound is unloaded. Returns false, if the sample format is not
+        /// supported by the backend.
+        bool SetSoundData(SoundHandle sound, const WaveData &wave);
         void UnloadSound(SoundHandle sound);
 
+        /// A sound can take the channel of a playing sound with lower
+        /// priority, when all the channels are in use.
+        void SetSoundPriority(SoundHandle sound, int priority);
+
         void SetMasterVolume(float volume);
 
         void SetMute(bool mute);
         void ToggleMute();
         bool IsMuted() const;
 
+        /// Plays the sound on a free channel. When there is none, the least
+        /// audible sound of the lowest priority is stopped, unless the new
+        /// sound is even less important. Sounds too far to be heard are not
+        /// played at all.
         void PlaySound(SoundHandle sound, float volume, float x, float y, Time_t currentTime);
-
+        /// Returns the number of channels playing the sound. The channels are
+        /// polled periodically, so sounds that just ended may be included.
+        size_t_32 GetPlayingCount(SoundHandle sound) const;
+
+        /// Plays long sounds like music without copying the samples to the
+        /// device at once. The samples must stay valid until the stream is
+        /// stopped.
+        StreamHandle PlayStream(const WaveData &wave, float volume, bool looping);
+        void StopStream(StreamHandle stream);
+        void SetStreamVolume(StreamHandle stream, float volume);
+        bool IsStreamPlaying(StreamHandle stream) const;
+
+        /// Frees the channels that have stopped and wakes up the audio thread
+        /// to apply the changes made during the frame.
         void Update();
 
     private:
-        ALCdevice *m_device;
-        ALCcontext *m_context;
+        struct Channel
+        {
+            Sound *playingSound;
+            uint32_t startTime;
+            float audibility;
+
+            float GetAudibility(uint32_t currentTime) const;
+        };
+
+        bool CreateBackend(const AudioConfig &config);
+        float GetAudibility(float volume, float x, float y) const;
+        size_t_32 FindChannelToSteal(uint32_t timeMillis) const;
+        /// Moves the stopped channels to the free list.
+        void PollChannels();
+        void FreeChannel(size_t_32 activeIndex);
+
+    private:
+        LinearAllocator &m_alloc;
+        AudioBackend *m_backend;
+        AudioSink *m_sink;
+        AudioThread *m_thread;
         Pool<Sound> m_sounds;
-        Pool<Channel> m_channelPool;
-        Channel *m_channels[MAX_CHANNELS];
+        Channel m_channels[MAX_CHANNELS];
+        uint8_t m_freeChannels[MAX_CHANNELS];
+        size_t_32 m_freeCount;
+        uint8_t m_activeChannels[MAX_CHANNELS];
+        size_t_32 m_activeCount;
+        MicroTicker m_ticker;
+        Time_t m_lastPoll;
         float m_masterVolume;
         bool m_muted;
     };
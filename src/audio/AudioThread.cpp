@@ -0,0 +1,288 @@
+
+#include "AudioThread.h"
+
+#include "../Assert.h"
+#include "../Log.h"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+namespace rob
+{
+
+    // The audio thread wakes up at least this often to refill the streams
+    // and to poll the sources.
+    static const Uint32 AUDIO_THREAD_INTERVAL_MS = 5;
+
+    AudioThread::AudioThread(AudioBackend &backend)
+        : m_backend(backend)
+        , m_thread(nullptr)
+        , m_mutex(nullptr)
+        , m_cond(nullptr)
+        , m_quit(false)
+        , m_channels()
+        , m_streams()
+        , m_commands()
+    {
+        m_mutex = ::SDL_CreateMutex();
+        m_cond = ::SDL_CreateCond();
+        m_thread = ::SDL_CreateThread(&AudioThread::ThreadMain, "Audio", this);
+        if (!m_thread)
+            log::Error("AudioThread: Could not create thread: ", ::SDL_GetError());
+    }
+
+    AudioThread::~AudioThread()
+    {
+        m_quit.store(true, std::memory_order_release);
+        ::SDL_LockMutex(m_mutex);
+        ::SDL_CondSignal(m_cond);
+        ::SDL_UnlockMutex(m_mutex);
+        if (m_thread)
+            ::SDL_WaitThread(m_thread, nullptr);
+
+        ::SDL_DestroyCond(m_cond);
+        ::SDL_DestroyMutex(m_mutex);
+    }
+
+    void AudioThread::Push(const Command &command)
+    {
+        if (!m_thread)
+        {
+            // Without the thread the command is executed right away.
+            Execute(command);
+            return;
+        }
+
+        while (!m_commands.Push(command))
+        {
+            // Let the audio thread catch up.
+            ::SDL_CondSignal(m_cond);
+            ::SDL_Delay(0);
+        }
+    }
+
+    bool AudioThread::SetSoundData(SoundHandle sound, const WaveData &wave)
+    {
+        if (!m_backend.IsFormatSupported(wave))
+        {
+            log::Error(m_backend.GetName(), ": Unsupported sound format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits, ", wave.m_frequency, " Hz");
+            return false;
+        }
+        Command command = { };
+        command.type = CommandType::SetSoundData;
+        command.index = sound;
+        command.wave = wave;
+        Push(command);
+        return true;
+    }
+
+    void AudioThread::ReleaseSound(SoundHandle sound)
+    {
+        Command command = { };
+        command.type = CommandType::ReleaseSound;
+        command.index = sound;
+        Push(command);
+    }
+
+    void AudioThread::SetMasterGain(float gain)
+    {
+        Command command = { };
+        command.type = CommandType::SetMasterGain;
+        command.gain = gain;
+        Push(command);
+    }
+
+    void AudioThread::PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        Source &source = m_channels[channel];
+        source.generation++;
+        source.playing = true;
+
+        Command command = { };
+        command.type = CommandType::PlayChannel;
+        command.index = channel;
+        command.generation = source.generation;
+        command.sound = sound;
+        command.gain = gain;
+        command.x = x;
+        command.y = y;
+        Push(command);
+    }
+
+    void AudioThread::StopChannel(size_t_32 channel)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        m_channels[channel].playing = false;
+
+        Command command = { };
+        command.type = CommandType::StopChannel;
+        command.index = channel;
+        Push(command);
+    }
+
+    bool AudioThread::IsChannelPlaying(size_t_32 channel) const
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        const Source &source = m_channels[channel];
+        return source.playing
+            && source.finishedGeneration.load(std::memory_order_acquire) != source.generation;
+    }
+
+    bool AudioThread::PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        if (!m_backend.IsFormatSupported(wave))
+        {
+            log::Error(m_backend.GetName(), ": Unsupported stream format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits, ", wave.m_frequency, " Hz");
+            return false;
+        }
+
+        Source &source = m_streams[stream];
+        source.generation++;
+        source.playing = true;
+
+        Command command = { };
+        command.type = CommandType::PlayStream;
+        command.looping = looping;
+        command.index = stream;
+        command.generation = source.generation;
+        command.gain = gain;
+        command.wave = wave;
+        Push(command);
+        return true;
+    }
+
+    void AudioThread::StopStream(size_t_32 stream)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        m_streams[stream].playing = false;
+
+        Command command = { };
+        command.type = CommandType::StopStream;
+        command.index = stream;
+        Push(command);
+    }
+
+    void AudioThread::SetStreamGain(size_t_32 stream, float gain)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        Command command = { };
+        command.type = CommandType::SetStreamGain;
+        command.index = stream;
+        command.gain = gain;
+        Push(command);
+    }
+
+    bool AudioThread::IsStreamPlaying(size_t_32 stream) const
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        const Source &source = m_streams[stream];
+        return source.playing
+            && source.finishedGeneration.load(std::memory_order_acquire) != source.generation;
+    }
+
+    void AudioThread::Update()
+    {
+        if (!m_thread)
+        {
+            m_backend.Update();
+            PollSources();
+            return;
+        }
+        // A signal missed while the thread is busy only delays the commands
+        // until the next wake up.
+        ::SDL_CondSignal(m_cond);
+    }
+
+    int AudioThread::ThreadMain(void *audioThread)
+    {
+        static_cast<AudioThread*>(audioThread)->Run();
+        return 0;
+    }
+
+    void AudioThread::Run()
+    {
+        while (!m_quit.load(std::memory_order_acquire))
+        {
+            ExecuteCommands();
+            m_backend.Update();
+            PollSources();
+
+            ::SDL_LockMutex(m_mutex);
+            if (!m_quit.load(std::memory_order_acquire))
+                ::SDL_CondWaitTimeout(m_cond, m_mutex, AUDIO_THREAD_INTERVAL_MS);
+            ::SDL_UnlockMutex(m_mutex);
+        }
+    }
+
+    void AudioThread::ExecuteCommands()
+    {
+        Command command;
+        while (m_commands.Pop(command))
+            Execute(command);
+    }
+
+    void AudioThread::Execute(const Command &command)
+    {
+        switch (command.type)
+        {
+        case CommandType::SetSoundData:
+            m_backend.SetSoundData(command.index, command.wave);
+            break;
+        case CommandType::ReleaseSound:
+            m_backend.ReleaseSound(command.index);
+            break;
+        case CommandType::SetMasterGain:
+            m_backend.SetMasterGain(command.gain);
+            break;
+        case CommandType::PlayChannel:
+            m_backend.PlayChannel(command.index, command.sound, command.gain, command.x, command.y);
+            m_channels[command.index].appliedGeneration = command.generation;
+            m_channels[command.index].polling = true;
+            break;
+        case CommandType::StopChannel:
+            m_backend.StopChannel(command.index);
+            m_channels[command.index].polling = false;
+            break;
+        case CommandType::PlayStream:
+            m_backend.PlayStream(command.index, command.wave, command.gain, command.looping);
+            m_streams[command.index].appliedGeneration = command.generation;
+            m_streams[command.index].polling = true;
+            break;
+        case CommandType::StopStream:
+            m_backend.StopStream(command.index);
+            m_streams[command.index].polling = false;
+            break;
+        case CommandType::SetStreamGain:
+            m_backend.SetStreamGain(command.index, command.gain);
+            break;
+        }
+    }
+
+    void AudioThread::PollSources()
+    {
+        for (size_t_32 i = 0; i < MAX_CHANNELS; i++)
+        {
+            Source &source = m_channels[i];
+            if (source.polling && !m_backend.IsChannelPlaying(i))
+            {
+                source.polling = false;
+                source.finishedGeneration.store(source.appliedGeneration, std::memory_order_release);
+            }
+        }
+        for (size_t_32 i = 0; i < MAX_STREAMS; i++)
+        {
+            Source &source = m_streams[i];
+            if (source.polling && !m_backend.IsStreamPlaying(i))
+            {
+                source.polling = false;
+                source.finishedGeneration.store(source.appliedGeneration, std::memory_order_release);
+            }
+        }
+    }
+
+} // rob
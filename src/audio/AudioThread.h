@@ -0,0 +1,116 @@
+
+#ifndef H_ROB_AUDIO_THREAD_H
+#define H_ROB_AUDIO_THREAD_H
+
+#include "AudioBackend.h"
+#include "../util/SpscQueue.h"
+
+#include <atomic>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+namespace rob
+{
+
+    /// Runs a backend in a dedicated thread. The calls from the main thread
+    /// are queued as commands to a lock-free queue, which the audio thread
+    /// drains. The audio thread also updates the backend and polls, which
+    /// of the channels and streams have stopped.
+    class AudioThread : public AudioBackend
+    {
+    public:
+        explicit AudioThread(AudioBackend &backend);
+        AudioThread(const AudioThread&) = delete;
+        AudioThread& operator = (const AudioThread&) = delete;
+        ~AudioThread();
+
+        const char* GetName() const override { return m_backend.GetName(); }
+        bool IsFormatSupported(const WaveData &wave) const override
+        { return m_backend.IsFormatSupported(wave); }
+
+        bool SetSoundData(SoundHandle sound, const WaveData &wave) override;
+        void ReleaseSound(SoundHandle sound) override;
+
+        void SetMasterGain(float gain) override;
+
+        void PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y) override;
+        void StopChannel(size_t_32 channel) override;
+        /// Returns the state last published by the audio thread.
+        bool IsChannelPlaying(size_t_32 channel) const override;
+
+        bool PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping) override;
+        void StopStream(size_t_32 stream) override;
+        void SetStreamGain(size_t_32 stream, float gain) override;
+        bool IsStreamPlaying(size_t_32 stream) const override;
+
+        /// Wakes up the audio thread to apply the commands queued during the frame.
+        void Update() override;
+
+    private:
+        enum class CommandType : uint8_t
+        {
+            SetSoundData,
+            ReleaseSound,
+            SetMasterGain,
+            PlayChannel,
+            StopChannel,
+            PlayStream,
+            StopStream,
+            SetStreamGain
+        };
+
+        struct Command
+        {
+            CommandType type;
+            bool looping;
+            /// Sound handle, channel or stream index.
+            uint32_t index;
+            uint32_t generation;
+            SoundHandle sound;
+            float gain;
+            float x, y;
+            WaveData wave;
+        };
+
+        /// State of a channel or a stream. Each play gets a new generation,
+        /// so that the audio thread reporting an earlier play to have ended
+        /// is not mistaken for the latest one.
+        struct Source
+        {
+            // Main thread
+            uint32_t generation;
+            bool playing;
+            // Audio thread
+            uint32_t appliedGeneration;
+            bool polling;
+            /// Generation of the last play that the audio thread saw end.
+            std::atomic<uint32_t> finishedGeneration;
+        };
+
+        static const uint32_t COMMAND_QUEUE_SIZE = 256;
+
+        static int ThreadMain(void *audioThread);
+        void Run();
+
+        void Push(const Command &command);
+        void ExecuteCommands();
+        void Execute(const Command &command);
+        /// Publishes the channels and streams that have stopped.
+        void PollSources();
+
+    private:
+        AudioBackend &m_backend;
+        SDL_Thread *m_thread;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_cond;
+        std::atomic<bool> m_quit;
+        Source m_channels[MAX_CHANNELS];
+        Source m_streams[MAX_STREAMS];
+        SpscQueue<Command, COMMAND_QUEUE_SIZE> m_commands;
+    };
+
+} // rob
+
+#endif // H_ROB_AUDIO_THREAD_H
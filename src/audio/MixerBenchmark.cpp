@@ -0,0 +1,96 @@
+
+#include "MixerBenchmark.h"
+#include "SoftwareMixer.h"
+
+#include "../time/MicroTicker.h"
+#include "../Log.h"
+
+#include <cmath>
+
+namespace rob
+{
+
+    static const uint32_t FREQUENCY = SoftwareMixer::OUTPUT_FREQUENCY;
+    // Seconds of audio mixed per measurement.
+    static const uint32_t BENCHMARK_SECONDS = 10;
+    // Frames mixed per call, like an audio device would request.
+    static const uint32_t BENCHMARK_FRAMES = 1024;
+
+    static int16_t g_monoSamples[FREQUENCY];
+    static int16_t g_stereoSamples[FREQUENCY * 2];
+    static int16_t g_output[BENCHMARK_FRAMES * SoftwareMixer::OUTPUT_CHANNELS];
+
+    static void FillSamples()
+    {
+        for (uint32_t i = 0; i < FREQUENCY; i++)
+        {
+            const int16_t s = int16_t(8000.0f * std::sin(float(i) * 0.0627f));
+            g_monoSamples[i] = s;
+            g_stereoSamples[i * 2] = s;
+            g_stereoSamples[i * 2 + 1] = -s;
+        }
+    }
+
+    /// Returns the microseconds taken to mix a second of audio with the voices.
+    static double MeasureMixing(SoftwareMixer &mixer, SoundHandle sound, size_t_32 voiceCount)
+    {
+        MicroTicker ticker;
+        ticker.Init();
+        const Time_t start = ticker.GetTicks();
+        for (uint32_t second = 0; second < BENCHMARK_SECONDS; second++)
+        {
+            // The sounds are a second long, so the voices play the whole time.
+            for (size_t_32 i = 0; i < voiceCount; i++)
+            {
+                const float x = float(i) - float(voiceCount) * 0.5f;
+                mixer.PlayChannel(i, sound, 1.0f, x, 0.0f);
+            }
+            for (uint32_t frames = 0; frames < FREQUENCY; frames += BENCHMARK_FRAMES)
+            {
+                const uint32_t count = (FREQUENCY - frames < BENCHMARK_FRAMES) ? FREQUENCY - frames : BENCHMARK_FRAMES;
+                mixer.Mix(g_output, count);
+            }
+        }
+        return double(ticker.GetTicks() - start) / BENCHMARK_SECONDS;
+    }
+
+    void RunMixerBenchmark()
+    {
+        FillSamples();
+
+        WaveData wave;
+        wave.m_bitsPerSample = 16;
+        wave.m_frequency = FREQUENCY;
+
+        SoftwareMixer mixer;
+        wave.m_samples = reinterpret_cast<const uint8_t*>(g_monoSamples);
+        wave.m_size = sizeof(g_monoSamples);
+        wave.m_channels = 1;
+        mixer.SetSoundData(0, wave);
+        wave.m_samples = reinterpret_cast<const uint8_t*>(g_stereoSamples);
+        wave.m_size = sizeof(g_stereoSamples);
+        wave.m_channels = 2;
+        mixer.SetSoundData(1, wave);
+
+#if defined(__SSE2__)
+        log::Info("Mixer benchmark (SSE2), microseconds per second of audio:");
+#else
+        log::Info("Mixer benchmark (scalar), microseconds per second of audio:");
+#endif
+        const char * const names[] = { "mono", "stereo" };
+        const size_t_32 voiceCounts[] = { 1, 4, 8, 16 };
+        for (SoundHandle sound = 0; sound < 2; sound++)
+        {
+            // The cost of clearing and converting the output without voices.
+            const double base = MeasureMixing(mixer, sound, 0);
+            log::Info("  ", names[sound], ", no voices: ", base);
+            for (size_t_32 voices : voiceCounts)
+            {
+                const double total = MeasureMixing(mixer, sound, voices);
+                log::Info("  ", names[sound], ", ", voices, " voices: ", total,
+                          " (", (total - base) / voices, " per voice)");
+            }
+        }
+    }
+
+} // rob
@@ -0,0 +1,14 @@
+
+#ifndef H_ROB_MIXER_BENCHMARK_H
+#define H_ROB_MIXER_BENCHMARK_H
+
+namespace rob
+{
+
+    /// Measures the cost of mixing a voice in the SoftwareMixer and logs
+    /// the results. Run with the --mixer-benchmark command line option.
+    void RunMixerBenchmark();
+
+} // rob
+
+#endif // H_ROB_MIXER_BENCHMARK_H
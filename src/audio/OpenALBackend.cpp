@@ -0,0 +1,334 @@
+
+#include "OpenALBackend.h"
+#include "ALCheck.h"
+
+#include "../Assert.h"
+#include "../Log.h"
+
+namespace rob
+{
+
+    // Multiple of all sample frame sizes.
+    static const size_t_32 STREAM_CHUNK_SIZE = 16 * 1024;
+
+    static ALenum GetALFormat(uint16_t channels, uint16_t bitsPerSample)
+    {
+        if (bitsPerSample == 8)
+        {
+            if (channels == 1) return AL_FORMAT_MONO8;
+            if (channels == 2) return AL_FORMAT_STEREO8;
+        }
+        else if (bitsPerSample == 16)
+        {
+            if (channels == 1) return AL_FORMAT_MONO16;
+            if (channels == 2) return AL_FORMAT_STEREO16;
+        }
+        return 0;
+    }
+
+    void OpenALBackend::Stream::Create()
+    {
+        source = 0;
+        alGenSources(1, &source);
+        AL_CHECK;
+        alGenBuffers(STREAM_BUFFER_COUNT, buffers);
+        AL_CHECK;
+        // Streams are not positional.
+        alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+        AL_CHECK;
+        alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+        AL_CHECK;
+        data = nullptr;
+        size = position = 0;
+        format = 0;
+        frequency = 0;
+        looping = playing = false;
+    }
+
+    void OpenALBackend::Stream::Destroy()
+    {
+        Stop();
+        alDeleteSources(1, &source);
+        AL_CHECK;
+        alDeleteBuffers(STREAM_BUFFER_COUNT, buffers);
+        AL_CHECK;
+    }
+
+    void OpenALBackend::Stream::Play(const WaveData &wave, ALenum alFormat, float gain, bool loop)
+    {
+        Stop();
+        data = wave.m_samples;
+        // Keep the chunks aligned to whole sample frames.
+        const uint32_t frameSize = wave.m_channels * wave.m_bitsPerSample / 8;
+        size = wave.m_size - wave.m_size % frameSize;
+        position = 0;
+        format = alFormat;
+        frequency = wave.m_frequency;
+        looping = loop;
+        playing = true;
+
+        alSourcef(source, AL_GAIN, gain);
+        AL_CHECK;
+
+        size_t_32 queued = 0;
+        for (; queued < STREAM_BUFFER_COUNT; queued++)
+        {
+            if (!Fill(buffers[queued])) break;
+        }
+        alSourceQueueBuffers(source, queued, buffers);
+        AL_CHECK;
+        alSourcePlay(source);
+        AL_CHECK;
+    }
+
+    bool OpenALBackend::Stream::Fill(ALuint buffer)
+    {
+        if (position >= size)
+        {
+            if (!looping || size == 0) return false;
+            position = 0;
+        }
+        uint32_t chunk = size - position;
+        if (chunk > STREAM_CHUNK_SIZE)
+            chunk = STREAM_CHUNK_SIZE;
+        alBufferData(buffer, format, data + position, chunk, frequency);
+        AL_CHECK;
+        position += chunk;
+        return true;
+    }
+
+    void OpenALBackend::Stream::Stop()
+    {
+        if (!playing) return;
+        alSourceStop(source);
+        AL_CHECK;
+        // Unqueues all the buffers.
+        alSourcei(source, AL_BUFFER, 0);
+        AL_CHECK;
+        playing = false;
+    }
+
+    void OpenALBackend::Stream::Update()
+    {
+        if (!playing) return;
+
+        ALint processed = 0;
+        alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+        AL_CHECK;
+
+        bool ended = false;
+        for (; processed > 0; processed--)
+        {
+            ALuint buffer = 0;
+            alSourceUnqueueBuffers(source, 1, &buffer);
+            AL_CHECK;
+            if (!ended && Fill(buffer))
+            {
+                alSourceQueueBuffers(source, 1, &buffer);
+                AL_CHECK;
+            }
+            else
+            {
+                ended = true;
+            }
+        }
+
+        ALint state = 0;
+        alGetSourcei(source, AL_SOURCE_STATE, &state);
+        AL_CHECK;
+        if (state == AL_STOPPED)
+        {
+            ALint queued = 0;
+            alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+            AL_CHECK;
+            // Restart after an underrun, or finish, if there is no more data.
+            if (queued > 0)
+                alSourcePlay(source);
+            else
+                playing = false;
+            AL_CHECK;
+        }
+    }
+
+    OpenALBackend::OpenALBackend()
+        : m_device(nullptr)
+        , m_context(nullptr)
+        , m_buffers()
+        , m_sources()
+        , m_streams()
+    { }
+
+    OpenALBackend::~OpenALBackend()
+    {
+        if (m_context)
+        {
+            for (size_t_32 i = 0; i < MAX_STREAMS; i++)
+                m_streams[i].Destroy();
+            alDeleteSources(MAX_CHANNELS, m_sources);
+            AL_CHECK;
+            for (size_t_32 i = 0; i < MAX_SOUNDS; i++)
+                ReleaseSound(i);
+            alcMakeContextCurrent(nullptr);
+            alcDestroyContext(m_context);
+        }
+        if (m_device) alcCloseDevice(m_device);
+    }
+
+    bool OpenALBackend::Init()
+    {
+        m_device = alcOpenDevice(nullptr);
+        AL_CHECK;
+
+        if (m_device == nullptr)
+        {
+            log::Error("Could not open audio device.");
+            return false;
+        }
+
+        m_context = alcCreateContext(m_device, nullptr);
+        AL_CHECK;
+
+        if (m_context == nullptr)
+        {
+            log::Error("Could not create audio context.");
+            return false;
+        }
+
+        alcMakeContextCurrent(m_context);
+        AL_CHECK;
+
+        alGenSources(MAX_CHANNELS, m_sources);
+        AL_CHECK;
+        for (size_t_32 i = 0; i < MAX_STREAMS; i++)
+            m_streams[i].Create();
+
+        // AudioSystem estimates the gain with this model.
+        alDistanceModel(AL_INVERSE_DISTANCE_CLAMPED);
+        AL_CHECK;
+        alListener3f(AL_POSITION, 0.0f, 0.0f, LISTENER_Z);
+        AL_CHECK;
+        return true;
+    }
+
+    bool OpenALBackend::IsFormatSupported(const WaveData &wave) const
+    {
+        return GetALFormat(wave.m_channels, wave.m_bitsPerSample) != 0;
+    }
+
+    bool OpenALBackend::SetSoundData(SoundHandle sound, const WaveData &wave)
+    {
+        ROB_ASSERT(sound < MAX_SOUNDS);
+        const ALenum format = GetALFormat(wave.m_channels, wave.m_bitsPerSample);
+        if (format == 0)
+        {
+            log::Error("Unsupported sound format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits");
+            return false;
+        }
+
+        if (m_buffers[sound] == 0)
+        {
+            alGenBuffers(1, &m_buffers[sound]);
+            AL_CHECK;
+        }
+        alBufferData(m_buffers[sound], format, wave.m_samples, wave.m_size, wave.m_frequency);
+        AL_CHECK;
+        return true;
+    }
+
+    void OpenALBackend::ReleaseSound(SoundHandle sound)
+    {
+        ROB_ASSERT(sound < MAX_SOUNDS);
+        if (m_buffers[sound] == 0) return;
+        alDeleteBuffers(1, &m_buffers[sound]);
+        AL_CHECK;
+        m_buffers[sound] = 0;
+    }
+
+    void OpenALBackend::SetMasterGain(float gain)
+    {
+        alListenerf(AL_GAIN, gain);
+        AL_CHECK;
+    }
+
+    void OpenALBackend::PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS && sound < MAX_SOUNDS);
+        const ALuint source = m_sources[channel];
+
+        alSourcef(source, AL_PITCH, 1.0f);
+        AL_CHECK;
+        alSourcef(source, AL_GAIN, gain);
+        AL_CHECK;
+        alSource3f(source, AL_POSITION, x, y, 0.0f);
+        AL_CHECK;
+        alSource3f(source, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
+        AL_CHECK;
+        alSourcei(source, AL_LOOPING, AL_FALSE);
+        AL_CHECK;
+
+        alSourcei(source, AL_BUFFER, m_buffers[sound]);
+        AL_CHECK;
+
+        alSourcePlay(source);
+        AL_CHECK;
+    }
+
+    void OpenALBackend::StopChannel(size_t_32 channel)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        alSourceStop(m_sources[channel]);
+        AL_CHECK;
+        alSourcei(m_sources[channel], AL_BUFFER, 0);
+        AL_CHECK;
+    }
+
+    bool OpenALBackend::IsChannelPlaying(size_t_32 channel) const
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        ALint state = 0;
+        alGetSourcei(m_sources[channel], AL_SOURCE_STATE, &state);
+        AL_CHECK;
+        return state != AL_STOPPED;
+    }
+
+    bool OpenALBackend::PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        const ALenum format = GetALFormat(wave.m_channels, wave.m_bitsPerSample);
+        if (format == 0)
+        {
+            log::Error("Unsupported stream format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits");
+            return false;
+        }
+        m_streams[stream].Play(wave, format, gain, looping);
+        return true;
+    }
+
+    void OpenALBackend::StopStream(size_t_32 stream)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        m_streams[stream].Stop();
+    }
+
+    void OpenALBackend::SetStreamGain(size_t_32 stream, float gain)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        alSourcef(m_streams[stream].source, AL_GAIN, gain);
+        AL_CHECK;
+    }
+
+    bool OpenALBackend::IsStreamPlaying(size_t_32 stream) const
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        return m_streams[stream].playing;
+    }
+
+    void OpenALBackend::Update()
+    {
+        for (size_t_32 i = 0; i < MAX_STREAMS; i++)
+            m_streams[i].Update();
+    }
+
+} // rob
@@ -0,0 +1,80 @@
+
+#ifndef H_ROB_OPENAL_BACKEND_H
+#define H_ROB_OPENAL_BACKEND_H
+
+#include "AudioBackend.h"
+
+#include <AL/al.h>
+#include <AL/alc.h>
+
+namespace rob
+{
+
+    class OpenALBackend : public AudioBackend
+    {
+    public:
+        OpenALBackend();
+        OpenALBackend(const OpenALBackend&) = delete;
+        OpenALBackend& operator = (const OpenALBackend&) = delete;
+        ~OpenALBackend();
+
+        /// Opens the default device. Returns false, if there is none.
+        bool Init();
+
+        const char* GetName() const override { return "OpenAL"; }
+        bool IsFormatSupported(const WaveData &wave) const override;
+
+        bool SetSoundData(SoundHandle sound, const WaveData &wave) override;
+        void ReleaseSound(SoundHandle sound) override;
+
+        void SetMasterGain(float gain) override;
+
+        void PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y) override;
+        void StopChannel(size_t_32 channel) override;
+        bool IsChannelPlaying(size_t_32 channel) const override;
+
+        bool PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping) override;
+        void StopStream(size_t_32 stream) override;
+        void SetStreamGain(size_t_32 stream, float gain) override;
+        bool IsStreamPlaying(size_t_32 stream) const override;
+
+        void Update() override;
+
+    private:
+        static const size_t_32 STREAM_BUFFER_COUNT = 4;
+
+        /// Plays samples from memory through a ring of queued buffers, so the
+        /// device memory used stays constant regardless of the sound length.
+        struct Stream
+        {
+            ALuint source;
+            ALuint buffers[STREAM_BUFFER_COUNT];
+            const uint8_t *data;
+            uint32_t size;
+            uint32_t position;
+            ALenum format;
+            uint32_t frequency;
+            bool looping;
+            bool playing;
+
+            void Create();
+            void Destroy();
+            void Play(const WaveData &wave, ALenum alFormat, float gain, bool loop);
+            /// Fills the buffer with the next chunk. Returns false at the end
+            /// of a non-looping stream.
+            bool Fill(ALuint buffer);
+            void Stop();
+            void Update();
+        };
+
+    private:
+        ALCdevice *m_device;
+        ALCcontext *m_context;
+        ALuint m_buffers[MAX_SOUNDS];
+        ALuint m_sources[MAX_CHANNELS];
+        Stream m_streams[MAX_STREAMS];
+    };
+
+} // rob
+
+#endif // H_ROB_OPENAL_BACKEND_H
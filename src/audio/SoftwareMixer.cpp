@@ -0,0 +1,303 @@
+
+#include "SoftwareMixer.h"
+#include "AudioSink.h"
+
+#include "../Assert.h"
+#include "../Log.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rob
+{
+
+    static const float PI_4 = 0.785398163f;
+
+    /// Adds mono samples to the stereo accumulation buffer.
+    static void MixMono(float *acc, const int16_t *samples, uint32_t frameCount,
+                        float gainLeft, float gainRight)
+    {
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        const __m128 left = _mm_set1_ps(gainLeft);
+        const __m128 right = _mm_set1_ps(gainRight);
+        // The buffer is unaligned after a looping voice wraps around.
+        for (; i + 4 <= frameCount; i += 4)
+        {
+            // Sign extend the four samples to 32 bits.
+            const __m128i s16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128 s = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s16, s16), 16));
+            const __m128 l = _mm_mul_ps(s, left);
+            const __m128 r = _mm_mul_ps(s, right);
+            float *dst = acc + i * 2;
+            _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_unpacklo_ps(l, r)));
+            _mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), _mm_unpackhi_ps(l, r)));
+        }
+#endif
+        for (; i < frameCount; i++)
+        {
+            const float s = samples[i];
+            acc[i * 2] += s * gainLeft;
+            acc[i * 2 + 1] += s * gainRight;
+        }
+    }
+
+    /// Adds stereo samples to the stereo accumulation buffer.
+    static void MixStereo(float *acc, const int16_t *samples, uint32_t frameCount,
+                          float gainLeft, float gainRight)
+    {
+        const uint32_t sampleCount = frameCount * 2;
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        const __m128 gain = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+        for (; i + 8 <= sampleCount; i += 8)
+        {
+            const __m128i s16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s16, s16), 16));
+            const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s16, s16), 16));
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(lo, gain)));
+            _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(hi, gain)));
+        }
+#endif
+        for (; i < sampleCount; i += 2)
+        {
+            acc[i] += samples[i] * gainLeft;
+            acc[i + 1] += samples[i + 1] * gainRight;
+        }
+    }
+
+    /// Scales the accumulated samples and converts them to 16-bit with saturation.
+    static void ConvertOutput(int16_t *output, const float *acc, uint32_t sampleCount, float gain)
+    {
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        const __m128 g = _mm_set1_ps(gain);
+        for (; i + 8 <= sampleCount; i += 8)
+        {
+            const __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(acc + i), g));
+            const __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_load_ps(acc + i + 4), g));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < sampleCount; i++)
+        {
+            const float s = acc[i] * gain;
+            output[i] = (s >= 32767.0f) ? 32767
+                : (s <= -32768.0f) ? -32768
+                : int16_t(std::lrint(s));
+        }
+    }
+
+    SoftwareMixer::SoftwareMixer()
+        : m_sink(nullptr)
+        , m_sounds()
+        , m_voices()
+        , m_masterGain(1.0f)
+        , m_mixBuffer()
+    { }
+
+    void SoftwareMixer::Lock() const
+    { if (m_sink) m_sink->Lock(); }
+
+    void SoftwareMixer::Unlock() const
+    { if (m_sink) m_sink->Unlock(); }
+
+    bool SoftwareMixer::IsFormatSupported(const WaveData &wave) const
+    {
+        return wave.m_bitsPerSample == 16
+            && (wave.m_channels == 1 || wave.m_channels == 2)
+            && wave.m_frequency == OUTPUT_FREQUENCY;
+    }
+
+    bool SoftwareMixer::SetSoundData(SoundHandle sound, const WaveData &wave)
+    {
+        ROB_ASSERT(sound < MAX_SOUNDS);
+        if (!IsFormatSupported(wave))
+        {
+            log::Error("Software mixer: Unsupported sound format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits, ", wave.m_frequency, " Hz");
+            return false;
+        }
+
+        SoundData &data = m_sounds[sound];
+        data.samples = reinterpret_cast<const int16_t*>(wave.m_samples);
+        data.frameCount = wave.m_size / (wave.m_channels * 2);
+        data.channels = wave.m_channels;
+        return true;
+    }
+
+    void SoftwareMixer::ReleaseSound(SoundHandle sound)
+    {
+        ROB_ASSERT(sound < MAX_SOUNDS);
+        SoundData &data = m_sounds[sound];
+        Lock();
+        for (size_t_32 i = 0; i < MAX_VOICES; i++)
+        {
+            if (m_voices[i].samples == data.samples)
+                m_voices[i].playing = false;
+        }
+        Unlock();
+        data.samples = nullptr;
+        data.frameCount = 0;
+    }
+
+    void SoftwareMixer::SetMasterGain(float gain)
+    {
+        Lock();
+        m_masterGain = gain;
+        Unlock();
+    }
+
+    void SoftwareMixer::StartVoice(Voice &voice, const int16_t *samples, uint32_t frameCount,
+                                   uint16_t channels, float gainLeft, float gainRight, bool looping)
+    {
+        Lock();
+        voice.samples = samples;
+        voice.frameCount = frameCount;
+        voice.position = 0;
+        voice.channels = channels;
+        voice.gainLeft = gainLeft;
+        voice.gainRight = gainRight;
+        voice.looping = looping;
+        voice.playing = (frameCount > 0);
+        Unlock();
+    }
+
+    void SoftwareMixer::PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS && sound < MAX_SOUNDS);
+        const SoundData &data = m_sounds[sound];
+
+        // Inverse distance clamped attenuation like in OpenAL.
+        const float distance = std::sqrt(x * x + y * y + LISTENER_Z * LISTENER_Z);
+        const float attenuation = gain / (distance > 1.0f ? distance : 1.0f);
+
+        float left = attenuation, right = attenuation;
+        if (data.channels == 1)
+        {
+            // Equal power panning by the horizontal direction to the sound.
+            const float angle = (x / distance + 1.0f) * PI_4;
+            left *= std::cos(angle);
+            right *= std::sin(angle);
+        }
+        StartVoice(m_voices[channel], data.samples, data.frameCount, data.channels, left, right, false);
+    }
+
+    void SoftwareMixer::StopChannel(size_t_32 channel)
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        Lock();
+        m_voices[channel].playing = false;
+        Unlock();
+    }
+
+    bool SoftwareMixer::IsChannelPlaying(size_t_32 channel) const
+    {
+        ROB_ASSERT(channel < MAX_CHANNELS);
+        Lock();
+        const bool playing = m_voices[channel].playing;
+        Unlock();
+        return playing;
+    }
+
+    bool SoftwareMixer::PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        if (!IsFormatSupported(wave))
+        {
+            log::Error("Software mixer: Unsupported stream format: ", wave.m_channels, " channels, ",
+                       wave.m_bitsPerSample, " bits, ", wave.m_frequency, " Hz");
+            return false;
+        }
+        StartVoice(m_voices[MAX_CHANNELS + stream], reinterpret_cast<const int16_t*>(wave.m_samples),
+                   wave.m_size / (wave.m_channels * 2), wave.m_channels, gain, gain, looping);
+        return true;
+    }
+
+    void SoftwareMixer::StopStream(size_t_32 stream)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        Lock();
+        m_voices[MAX_CHANNELS + stream].playing = false;
+        Unlock();
+    }
+
+    void SoftwareMixer::SetStreamGain(size_t_32 stream, float gain)
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        Lock();
+        m_voices[MAX_CHANNELS + stream].gainLeft = gain;
+        m_voices[MAX_CHANNELS + stream].gainRight = gain;
+        Unlock();
+    }
+
+    bool SoftwareMixer::IsStreamPlaying(size_t_32 stream) const
+    {
+        ROB_ASSERT(stream < MAX_STREAMS);
+        Lock();
+        const bool playing = m_voices[MAX_CHANNELS + stream].playing;
+        Unlock();
+        return playing;
+    }
+
+    void SoftwareMixer::Update()
+    {
+        if (m_sink) m_sink->Pump();
+    }
+
+    void SoftwareMixer::MixVoice(Voice &voice, uint32_t frameCount)
+    {
+        float *acc = m_mixBuffer;
+        while (frameCount > 0)
+        {
+            uint32_t count = voice.frameCount - voice.position;
+            if (count > frameCount) count = frameCount;
+
+            const int16_t *samples = voice.samples + voice.position * voice.channels;
+            if (voice.channels == 1)
+                MixMono(acc, samples, count, voice.gainLeft, voice.gainRight);
+            else
+                MixStereo(acc, samples, count, voice.gainLeft, voice.gainRight);
+
+            acc += count * OUTPUT_CHANNELS;
+            frameCount -= count;
+            voice.position += count;
+            if (voice.position == voice.frameCount)
+            {
+                if (!voice.looping)
+                {
+                    voice.playing = false;
+                    return;
+                }
+                voice.position = 0;
+            }
+        }
+    }
+
+    void SoftwareMixer::MixBlock(int16_t *output, uint32_t frameCount)
+    {
+        std::memset(m_mixBuffer, 0, frameCount * OUTPUT_CHANNELS * sizeof(float));
+        for (size_t_32 i = 0; i < MAX_VOICES; i++)
+        {
+            if (m_voices[i].playing)
+                MixVoice(m_voices[i], frameCount);
+        }
+        ConvertOutput(output, m_mixBuffer, frameCount * OUTPUT_CHANNELS, m_masterGain);
+    }
+
+    void SoftwareMixer::Mix(int16_t *output, uint32_t frameCount)
+    {
+        while (frameCount > 0)
+        {
+            const uint32_t count = (frameCount < MIX_BLOCK_FRAMES) ? frameCount : MIX_BLOCK_FRAMES;
+            MixBlock(output, count);
+            output += count * OUTPUT_CHANNELS;
+            frameCount -= count;
+        }
+    }
+
+} // rob
@@ -0,0 +1,95 @@
+
+#ifndef H_ROB_SOFTWARE_MIXER_H
+#define H_ROB_SOFTWARE_MIXER_H
+
+#include "AudioBackend.h"
+
+namespace rob
+{
+
+    class AudioSink;
+
+    /// Mixes the sounds in software to interleaved 16-bit stereo. The output
+    /// is pulled by an AudioSink with Mix, possibly from another thread.
+    /// Only 16-bit mono and stereo samples at OUTPUT_FREQUENCY are supported,
+    /// which is what the SoundBuilder produces, so no resampling is done.
+    class SoftwareMixer : public AudioBackend
+    {
+    public:
+        static const uint32_t OUTPUT_FREQUENCY = 44100;
+        static const uint16_t OUTPUT_CHANNELS = 2;
+        /// Number of frames mixed at a time.
+        static const uint32_t MIX_BLOCK_FRAMES = 256;
+
+    public:
+        SoftwareMixer();
+        SoftwareMixer(const SoftwareMixer&) = delete;
+        SoftwareMixer& operator = (const SoftwareMixer&) = delete;
+
+        /// The sink is locked while the voices are changed.
+        void SetSink(AudioSink *sink) { m_sink = sink; }
+
+        /// Mixes the playing voices to the output frames.
+        void Mix(int16_t *output, uint32_t frameCount);
+
+        const char* GetName() const override { return "Software mixer"; }
+        bool IsFormatSupported(const WaveData &wave) const override;
+
+        bool SetSoundData(SoundHandle sound, const WaveData &wave) override;
+        void ReleaseSound(SoundHandle sound) override;
+
+        void SetMasterGain(float gain) override;
+
+        void PlayChannel(size_t_32 channel, SoundHandle sound, float gain, float x, float y) override;
+        void StopChannel(size_t_32 channel) override;
+        bool IsChannelPlaying(size_t_32 channel) const override;
+
+        bool PlayStream(size_t_32 stream, const WaveData &wave, float gain, bool looping) override;
+        void StopStream(size_t_32 stream) override;
+        void SetStreamGain(size_t_32 stream, float gain) override;
+        bool IsStreamPlaying(size_t_32 stream) const override;
+
+        /// Pumps the sink.
+        void Update() override;
+
+    private:
+        struct SoundData
+        {
+            const int16_t *samples;
+            uint32_t frameCount;
+            uint16_t channels;
+        };
+
+        struct Voice
+        {
+            const int16_t *samples;
+            uint32_t frameCount;
+            uint32_t position;
+            uint16_t channels;
+            float gainLeft;
+            float gainRight;
+            bool looping;
+            bool playing;
+        };
+
+        static const size_t_32 MAX_VOICES = MAX_CHANNELS + MAX_STREAMS;
+
+        void StartVoice(Voice &voice, const int16_t *samples, uint32_t frameCount,
+                        uint16_t channels, float gainLeft, float gainRight, bool looping);
+        void MixVoice(Voice &voice, uint32_t frameCount);
+        void MixBlock(int16_t *output, uint32_t frameCount);
+
+        void Lock() const;
+        void Unlock() const;
+
+    private:
+        AudioSink *m_sink;
+        SoundData m_sounds[MAX_SOUNDS];
+        Voice m_voices[MAX_VOICES];
+        float m_masterGain;
+        alignas(16) float m_mixBuffer[MIX_BLOCK_FRAMES * OUTPUT_CHANNELS];
+    };
+
+} // rob
+
+#endif // H_ROB_SOFTWARE_MIXER_H
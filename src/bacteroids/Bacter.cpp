@@ -97,12 +97,13 @@ namespace bact
         m_sizeMod = 1.0f;
     }
 
-    void Bacter::Render(Renderer *renderer, const BacteroidsUniforms &uniforms)
+    void Bacter::Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha)
     {
+        const vec2f p = GetRenderPosition(alpha);
         renderer->GetGraphics()->SetUniform(uniforms.m_anim, m_anim);
         renderer->SetColor(Color(1.0f, 1.2f, 0.6f));
-//            renderer->DrawFilledCirlce(m_position.x, m_position.y, m_radius);
-        renderer->DrawFilledCirlce(m_position.x, m_position.y, m_radius, Color(0.0f, 0.5f, 0.5f, 1.0f));
+//            renderer->DrawFilledCirlce(p.x, p.y, m_radius);
+        renderer->DrawFilledCirlce(p.x, p.y, m_radius, Color(0.0f, 0.5f, 0.5f, 1.0f));
     }
 
 } // bact
@@ -29,6 +29,8 @@ namespace bact
         void CopyAttributes(const Bacter *other)
         {
             m_position = other->m_position;
+            m_prevPosition = other->m_prevPosition;
+            m_hasPrevPosition = other->m_hasPrevPosition;
             m_velocity = other->m_velocity;
             m_radius = other->m_radius;
             m_alive = other->m_alive;
@@ -54,7 +56,7 @@ namespace bact
 
         void Update(const GameTime &gameTime, const Rect &playArea) override;
 
-        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms);
+        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha) override;
 
     private:
         float m_anim;
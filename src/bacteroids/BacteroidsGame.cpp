@@ -6,6 +6,7 @@
 #include "../application/Window.h"
 
 #include "../graphics/Graphics.h"
+#include "../resource/MasterCache.h"
 
 #include "Shaders.h"
 
@@ -24,16 +25,23 @@ namespace bact
         bool Initialize() override
         {
             m_gameData.m_score = -1;
+
+            // Warm up the resources of the game state while in the menu.
+            static const ResourceID gameResources[] = {
+                "Blip_Select7.snd", "Jump.snd", "Explosion5.snd", "Randomize6.snd"
+            };
+            GetCache().Prefetch(gameResources);
             return true;
         }
 
         ~MenuState()
         { }
 
+        bool IsIdle() const override
+        { return true; }
+
         void Render() override
         {
-            Delay(20);
-
             Renderer &renderer = GetRenderer();
             renderer.SetView(GetDefaultView());
             renderer.SetColor(Color(1.0f, 1.0f, 1.0f));
@@ -99,10 +107,11 @@ namespace bact
         bool InsertingNewScore() const
         { return m_scoreIndex != HighScoreList::INVALID_INDEX; }
 
+        bool IsIdle() const override
+        { return true; }
+
         void Render() override
         {
-            Delay(20);
-
             Renderer &renderer = GetRenderer();
             renderer.SetView(GetDefaultView());
             renderer.SetColor(Color(1.0f, 1.0f, 1.0f));
@@ -7,6 +7,7 @@
 #include "../graphics/Graphics.h"
 #include "../renderer/Renderer.h"
 #include "../application/Window.h"
+#include "../memory/FrameAllocator.h"
 
 #include "../math/Math.h"
 #include "../math/Projection.h"
@@ -69,8 +70,6 @@ namespace bact
         m_objects.Init(GetAllocator());
         m_objects.AddObject(&m_player);
 
-        m_quadTree = GetAllocator().AllocateArray<GameObject*>(MAX_OBJECTS);
-
         m_score = 0;
         m_kills = 0;
 
@@ -84,10 +83,10 @@ namespace bact
 
     BacteroidsState::~BacteroidsState()
     {
-        GetRenderer().GetGraphics()->DestroyShaderProgram(m_playerShader);
-        GetRenderer().GetGraphics()->DestroyShaderProgram(m_bacterShader);
-        GetRenderer().GetGraphics()->DestroyShaderProgram(m_projectileShader);
-        GetRenderer().GetGraphics()->DestroyShaderProgram(m_fontShader);
+        GetRenderer().ReleaseShaderProgram(m_playerShader);
+        GetRenderer().ReleaseShaderProgram(m_bacterShader);
+        GetRenderer().ReleaseShaderProgram(m_projectileShader);
+        GetRenderer().ReleaseShaderProgram(m_fontShader);
     }
 
     void BacteroidsState::OnResize(int w, int h)
@@ -256,6 +255,11 @@ namespace bact
 
     void BacteroidsState::DoCollisions()
     {
+        // The buckets are needed only during the step.
+        LinearAllocatorScope frameScope(GetFrameAllocator().GetAllocator());
+        GameObject **quadTree = GetFrameAllocator().AllocateArray<GameObject*>(m_objects.Size());
+        ROB_ASSERT(quadTree != nullptr);
+
     #include "CollisionTesting.inl"
     }
 
@@ -295,6 +299,9 @@ namespace bact
 
         m_soundPlayer.UpdateTime(gameTime);
 
+        for (size_t_32 i = 0; i < m_objects.Size(); i++)
+            m_objects[i]->SavePreviousState();
+
         UpdatePlayer(gameTime);
 
         DoCollisions();
@@ -324,6 +331,12 @@ namespace bact
         m_damageFade.Update(gameTime.GetDeltaSeconds());
     }
 
+    void BacteroidsState::PostUpdate()
+    {
+        // The sounds of all the steps in the frame are merged.
+        m_soundPlayer.Flush();
+    }
+
     void BacteroidsState::RenderPause()
     {
         Renderer &renderer = GetRenderer();
@@ -373,11 +386,13 @@ namespace bact
         renderer.SetColor(Color(0.05f, 0.13f, 0.15f));
         renderer.DrawFilledRectangle(PLAY_AREA_LEFT, PLAY_AREA_BOTTOM, PLAY_AREA_RIGHT, PLAY_AREA_TOP);
 
+        const float alpha = m_gameTime.GetInterpolationAlpha();
+
         for (size_t_32 i = 0; i < m_objects.Size(); i++)
         {
             GameObject *obj = m_objects[i];
 
-            vec2f p = obj->GetPosition();
+            vec2f p = obj->GetRenderPosition(alpha);
             float r = obj->GetRadius() * 1.1f;
 
             if ((p.x > PLAY_AREA_LEFT - r && p.x < PLAY_AREA_RIGHT + r &&
@@ -391,7 +406,7 @@ namespace bact
             const vec2f vel2 = obj->GetVelocity();
             const vec4f velocity(vel2.x, vel2.y, 0.0f, 0.0f);
             renderer.GetGraphics()->SetUniform(m_uniforms.m_velocity, velocity);
-            obj->Render(&renderer, m_uniforms);
+            obj->Render(&renderer, m_uniforms, alpha);
         }
 
         renderer.BindColorShader();
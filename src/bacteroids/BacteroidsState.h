@@ -34,6 +34,7 @@ namespace bact
         bool Initialize() override;
         void RealtimeUpdate(const Time_t deltaMicroseconds) override;
         void Update(const GameTime &gameTime) override;
+        void PostUpdate() override;
         void Render() override;
 
         void OnResize(int w, int h) override;
@@ -74,7 +75,6 @@ namespace bact
 
         Player m_player;
         ObjectArray m_objects;
-        GameObject **m_quadTree;
 
         int m_score;
         int m_kills;
@@ -18,11 +18,11 @@
             size_t_32 q2 = q[2]++;
             size_t_32 q3 = q[3]++;
             size_t_32 q4 = q[4]++;
-            m_quadTree[q4] = m_quadTree[q3];
-            m_quadTree[q3] = m_quadTree[q2];
-            m_quadTree[q2] = m_quadTree[q1];
-            m_quadTree[q1] = m_quadTree[q0];
-            m_quadTree[q0] = o;
+            quadTree[q4] = quadTree[q3];
+            quadTree[q3] = quadTree[q2];
+            quadTree[q2] = quadTree[q1];
+            quadTree[q1] = quadTree[q0];
+            quadTree[q0] = o;
         }
         else if (p.x + r < 0.0f && p.y - r > 0.0f)
         {
@@ -30,31 +30,31 @@
             size_t_32 q2 = q[2]++;
             size_t_32 q3 = q[3]++;
             size_t_32 q4 = q[4]++;
-            m_quadTree[q4] = m_quadTree[q3];
-            m_quadTree[q3] = m_quadTree[q2];
-            m_quadTree[q2] = m_quadTree[q1];
-            m_quadTree[q1] = o;
+            quadTree[q4] = quadTree[q3];
+            quadTree[q3] = quadTree[q2];
+            quadTree[q2] = quadTree[q1];
+            quadTree[q1] = o;
         }
         else if (p.x - r > 0.0f && p.y + r < 0.0f)
         {
             size_t_32 q2 = q[2]++;
             size_t_32 q3 = q[3]++;
             size_t_32 q4 = q[4]++;
-            m_quadTree[q4] = m_quadTree[q3];
-            m_quadTree[q3] = m_quadTree[q2];
-            m_quadTree[q2] = o;
+            quadTree[q4] = quadTree[q3];
+            quadTree[q3] = quadTree[q2];
+            quadTree[q2] = o;
         }
         else if (p.x - r > 0.0f && p.y - r > 0.0f)
         {
             size_t_32 q3 = q[3]++;
             size_t_32 q4 = q[4]++;
-            m_quadTree[q4] = m_quadTree[q3];
-            m_quadTree[q3] = o;
+            quadTree[q4] = quadTree[q3];
+            quadTree[q3] = o;
         }
         else
         {
             size_t_32 q4 = q[4]++;
-            m_quadTree[q4] = o;
+            quadTree[q4] = o;
         }
     }
 
@@ -62,13 +62,13 @@
     {
         for (; i < q[k]; i++)
         {
-            GameObject *obj1 = m_quadTree[i];
+            GameObject *obj1 = quadTree[i];
             vec2f p1 = obj1->GetPosition();
             float r1 = obj1->GetRadius();
 
             for (size_t_32 j = i + 1; j < q[k]; j++)
             {
-                GameObject *obj2 = m_quadTree[j];
+                GameObject *obj2 = quadTree[j];
                 vec2f p2 = obj2->GetPosition();
                 float r2 = obj2->GetRadius();
 
@@ -86,7 +86,7 @@
 
             for (size_t_32 j = q[3]; j < q[4]; j++)
             {
-                GameObject *obj2 = m_quadTree[j];
+                GameObject *obj2 = quadTree[j];
                 vec2f p2 = obj2->GetPosition();
                 float r2 = obj2->GetRadius();
 
@@ -49,6 +49,8 @@ namespace bact
         GameObject(int type)
             : m_type(type)
             , m_position(0.0f)
+            , m_prevPosition(0.0f)
+            , m_hasPrevPosition(false)
             , m_velocity(vec2f::Zero)
             , m_radius(1.0f)
             , m_alive(true)
@@ -66,6 +68,20 @@ namespace bact
         vec2f GetPosition() const
         { return m_position; }
 
+        /// Stores the current position as the previous step's position.
+        /// Should be called before each fixed step.
+        void SavePreviousState()
+        {
+            m_prevPosition = m_position;
+            m_hasPrevPosition = true;
+        }
+
+        /// Returns the position interpolated between the previous and the
+        /// current step. Objects spawned during the last step are rendered
+        /// at their current position.
+        vec2f GetRenderPosition(float alpha) const
+        { return m_hasPrevPosition ? Lerp(m_prevPosition, m_position, alpha) : m_position; }
+
         void SetRadius(float r)
         { m_radius = r; }
         float GetRadius() const
@@ -86,13 +102,15 @@ namespace bact
         { return !m_alive; }
 
         virtual void Update(const GameTime &gameTime, const Rect &playArea) { }
-        virtual void Render(Renderer *renderer, const BacteroidsUniforms &uniforms) { }
+        virtual void Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha) { }
 
         virtual ShaderProgramHandle GetShader() = 0;
 
     protected:
         int m_type;
         vec2f m_position;
+        vec2f m_prevPosition;
+        bool m_hasPrevPosition;
         vec2f m_velocity;
         float m_radius;
         bool m_alive;
@@ -13,73 +13,62 @@ namespace bact
 
     void ObjectArray::Init(LinearAllocator &alloc)
     {
-        m_size = 0;
-        m_bacterCount = 0;
-        m_projectileCount = 0;
+        m_otherCount = 0;
 
-        m_objects = alloc.AllocateArray<GameObject*>(MAX_OBJECTS);
-        const size_t_32 bacterPoolSize = GetArraySize<Bacter>(MAX_BACTERS);
-        m_bacterPool.SetMemory(alloc.AllocateArray<Bacter>(MAX_BACTERS), bacterPoolSize);
-        const size_t_32 projectilePoolSize = GetArraySize<Projectile>(MAX_PROJECTILES);
-        m_projectilePool.SetMemory(alloc.AllocateArray<Projectile>(MAX_PROJECTILES), projectilePoolSize);
+        m_bacters.SetName("Bacters", MemoryTag::State);
+        m_projectiles.SetName("Projectiles", MemoryTag::State);
+
+        // The storage must not grow, as the objects are referenced by
+        // pointers while new ones are obtained.
+        m_bacters.Init(alloc, MAX_BACTERS, false);
+        m_projectiles.Init(alloc, MAX_PROJECTILES, false);
     }
 
     GameObject *ObjectArray::operator[] (size_t_32 i)
     {
-        ROB_ASSERT(i < m_size);
-        return m_objects[i];
+        ROB_ASSERT(i < Size());
+        if (i < m_otherCount)
+            return m_others[i];
+        i -= m_otherCount;
+        if (i < m_bacters.Size())
+            return &m_bacters[i];
+        return &m_projectiles[i - m_bacters.Size()];
     }
 
     Bacter *ObjectArray::ObtainBacter()
     {
-        ROB_ASSERT(m_bacterCount < MAX_BACTERS);
-        Bacter *bacter = m_bacterPool.Obtain();
-        ROB_ASSERT(bacter != nullptr);
-        m_objects[m_size++] = bacter;
-        m_bacterCount++;
-        return bacter;
+        ROB_ASSERT(CanObtainBacter());
+        return m_bacters.Get(m_bacters.Create());
     }
 
     Projectile *ObjectArray::ObtainProjectile()
     {
-        ROB_ASSERT(m_projectileCount < MAX_PROJECTILES);
-        Projectile *proj = m_projectilePool.Obtain();
-        ROB_ASSERT(proj != nullptr);
-        m_objects[m_size++] = proj;
-        m_projectileCount++;
-        return proj;
+        ROB_ASSERT(CanObtainProjectile());
+        return m_projectiles.Get(m_projectiles.Create());
     }
 
     void ObjectArray::Remove(size_t_32 i)
     {
-        ROB_ASSERT(i < m_size); // means also "m_size > 0"
-
-        GameObject *obj = m_objects[i];
+        ROB_ASSERT(i < Size()); // means also "Size() > 0"
 
-        switch (obj->GetType())
+        if (i < m_otherCount)
         {
-        case Bacter::TYPE:
-            m_bacterPool.Return((Bacter*)obj);
-            m_bacterCount--;
-            break;
-
-        case Projectile::TYPE:
-            m_projectilePool.Return((Projectile*)obj);
-            m_projectileCount--;
-            break;
-
-        default:
-            break;
+            m_otherCount--;
+            m_others[i] = m_others[m_otherCount];
+            return;
         }
-
-        m_size--;
-        m_objects[i] = m_objects[m_size];
+        i -= m_otherCount;
+        if (i < m_bacters.Size())
+            m_bacters.DestroyAt(i);
+        else
+            m_projectiles.DestroyAt(i - m_bacters.Size());
     }
 
     void ObjectArray::RemoveAll()
     {
-        while (m_size > 0)
-            Remove(0);
+        m_otherCount = 0;
+        m_bacters.Clear();
+        m_projectiles.Clear();
     }
 
 } // bact
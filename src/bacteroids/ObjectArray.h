@@ -5,7 +5,7 @@
 #include "Bacter.h"
 #include "Projectile.h"
 
-#include "../memory/Pool.h"
+#include "../memory/SlotMap.h"
 
 #include "../Types.h"
 
@@ -21,8 +21,14 @@ namespace bact
 
     static const size_t_32 MAX_BACTERS = 500;
     static const size_t_32 MAX_PROJECTILES = 200;
-    static const size_t_32 MAX_OBJECTS = MAX_BACTERS + MAX_PROJECTILES + 1;
-
+    static const size_t_32 MAX_OTHER_OBJECTS = 1;
+    static const size_t_32 MAX_OBJECTS = MAX_BACTERS + MAX_PROJECTILES + MAX_OTHER_OBJECTS;
+
+    /// The game objects indexed as one array: the objects added with
+    /// AddObject first, then the bacters and then the projectiles. The
+    /// bacters and the projectiles are stored by value in slot maps, so they
+    /// can also be iterated densely by type. Removing an object moves the
+    /// last object of the same type to its index.
     class ObjectArray
     {
     public:
@@ -33,29 +39,35 @@ namespace bact
         GameObject *operator[] (size_t_32 i);
 
         size_t_32 Size() const
-        { return m_size; }
+        { return m_otherCount + m_bacters.Size() + m_projectiles.Size(); }
         bool CanObtainBacter() const
-        { return (m_bacterCount < MAX_BACTERS); }
+        { return !m_bacters.IsFull(); }
         bool CanObtainProjectile() const
-        { return (m_projectileCount < MAX_PROJECTILES); }
+        { return !m_projectiles.IsFull(); }
 
         void AddObject(GameObject *obj)
-        { m_objects[m_size++] = obj; }
+        {
+            ROB_ASSERT(m_otherCount < MAX_OTHER_OBJECTS);
+            m_others[m_otherCount++] = obj;
+        }
 
         Bacter *ObtainBacter();
         Projectile *ObtainProjectile();
 
+        SlotMap<Bacter>& GetBacters()
+        { return m_bacters; }
+        SlotMap<Projectile>& GetProjectiles()
+        { return m_projectiles; }
+
         void Remove(size_t_32 i);
         void RemoveAll();
 
     private:
-        size_t_32 m_size;
-        size_t_32 m_bacterCount;
-        size_t_32 m_projectileCount;
+        size_t_32 m_otherCount;
+        GameObject *m_others[MAX_OTHER_OBJECTS];
 
-        GameObject **m_objects;
-        Pool<Bacter> m_bacterPool;
-        Pool<Projectile> m_projectilePool;
+        SlotMap<Bacter> m_bacters;
+        SlotMap<Projectile> m_projectiles;
     };
 
 } // bact
@@ -101,13 +101,14 @@ namespace bact
         }
     }
 
-    void Player::Render(Renderer *renderer, const BacteroidsUniforms &uniforms)
+    void Player::Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha)
     {
+        const vec2f p = GetRenderPosition(alpha);
         renderer->SetColor(Color(1.0f, 1.0f, 1.6f));
-        renderer->DrawFilledCirlce(m_position.x, m_position.y, m_radius, Color(0.2f, 0.5f, 0.5f, 0.5f));
+        renderer->DrawFilledCirlce(p.x, p.y, m_radius, Color(0.2f, 0.5f, 0.5f, 0.5f));
 
         renderer->SetColor(Color(2.0f, 1.0f, 0.6f));
-        const vec2f dpos = m_position + ClampedVectorLength(m_direction, 1.5f);
+        const vec2f dpos = p + ClampedVectorLength(m_direction, 1.5f);
         renderer->BindColorShader();
         renderer->DrawFilledCirlce(dpos.x, dpos.y, m_radius * 0.5f, Color(0.2f, 0.5f, 0.5f, 0.5f));
     }
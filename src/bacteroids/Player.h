@@ -26,7 +26,7 @@ namespace bact
         void Cooldown(const GameTime &gameTime);
         void Shoot(const GameTime &gameTime, ObjectArray &projectiles, SoundPlayer &sounds);
 
-        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms) override;
+        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha) override;
 
     private:
         vec2f m_direction;
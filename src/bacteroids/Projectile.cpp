@@ -28,10 +28,11 @@ namespace bact
             m_alive = false;
     }
 
-    void Projectile::Render(Renderer *renderer, const BacteroidsUniforms &uniforms)
+    void Projectile::Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha)
     {
+        const vec2f p = GetRenderPosition(alpha);
         renderer->SetColor(Color(1.0f, 1.0f, 1.6f));
-        renderer->DrawFilledCirlce(m_position.x, m_position.y, m_radius, Color(0.2f, 0.5f, 0.5f, 0.5f));
+        renderer->DrawFilledCirlce(p.x, p.y, m_radius, Color(0.2f, 0.5f, 0.5f, 0.5f));
     }
 
 } // bact
@@ -17,7 +17,7 @@ namespace bact
 
         void Update(const GameTime &gameTime, const Rect &playArea) override;
 
-        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms) override;
+        void Render(Renderer *renderer, const BacteroidsUniforms &uniforms, float alpha) override;
     };
 
 } // bact
@@ -6,6 +6,8 @@
 #include "../resource/MasterCache.h"
 #include "../application/GameTime.h"
 
+#include <cmath>
+
 namespace bact
 {
 
@@ -13,26 +15,54 @@ namespace bact
 
     constexpr float PositionScale = 0.25f;
 
+    /// Collects the sounds triggered during a frame and plays them in Flush.
+    /// The triggers of the same sound in a frame are merged to one louder
+    /// sound at the centroid of the trigger positions.
     class SoundPlayer
     {
+        enum SoundType
+        {
+            SOUND_SHOOT,
+            SOUND_PLAYER_DAMAGE,
+            SOUND_PLAYER_DEATH,
+            SOUND_BACTER_SPLIT,
+            SOUND_TYPE_COUNT
+        };
+
+        struct SoundDef
+        {
+            SoundHandle m_sound;
+            float m_volume;
+            /// Maximum number of simultaneous instances of the sound.
+            size_t_32 m_maxInstances;
+            /// Minimum time between two plays of the sound in microseconds.
+            Time_t m_minInterval;
+            Time_t m_lastPlayTime;
+
+            // Triggers in the current frame
+            size_t_32 m_triggerCount;
+            float m_sumX, m_sumY;
+        };
+
     public:
         SoundPlayer()
             : m_audio(nullptr)
-//            , m_cache(nullptr)
             , m_currentTime(0)
-            , m_shootSound(InvalidSound)
-            , m_plDamageSound(InvalidSound)
-            , m_plDeathSound(InvalidSound)
-            , m_bactSplitSound(InvalidSound)
+            , m_sounds()
         { }
 
         void Init(AudioSystem &audio, MasterCache &cache)
         {
             m_audio = &audio;
-            m_shootSound = cache.GetSound("Blip_Select7.wav");
-            m_plDamageSound = cache.GetSound("Jump.wav");
-            m_plDeathSound = cache.GetSound("Explosion5.wav");
-            m_bactSplitSound = cache.GetSound("Randomize6.wav");
+            InitSound(SOUND_SHOOT,          cache.GetSound("Blip_Select7.snd"), 1.0f, 4, 30000);
+            InitSound(SOUND_PLAYER_DAMAGE,  cache.GetSound("Jump.snd"),         1.0f, 1, 100000);
+            InitSound(SOUND_PLAYER_DEATH,   cache.GetSound("Explosion5.snd"),   0.5f, 1, 0);
+            InitSound(SOUND_BACTER_SPLIT,   cache.GetSound("Randomize6.snd"),   0.5f, 4, 50000);
+
+            // The player sounds must not be cut off by the shots.
+            audio.SetSoundPriority(m_sounds[SOUND_SHOOT].m_sound, SOUND_PRIORITY_LOW);
+            audio.SetSoundPriority(m_sounds[SOUND_PLAYER_DAMAGE].m_sound, SOUND_PRIORITY_HIGH);
+            audio.SetSoundPriority(m_sounds[SOUND_PLAYER_DEATH].m_sound, SOUND_PRIORITY_HIGH);
         }
 
         void UpdateTime(const GameTime &gameTime)
@@ -41,38 +71,71 @@ namespace bact
         }
 
         void PlayShootSound(float x, float y)
-        {
-            x *= PositionScale; y *= PositionScale;
-            m_audio->PlaySound(m_shootSound, 1.0f, x, y, m_currentTime);
-        }
+        { Trigger(SOUND_SHOOT, x, y); }
 
         void PlayPlayerDamageSound(float x, float y)
+        { Trigger(SOUND_PLAYER_DAMAGE, x, y); }
+
+        void PlayPlayerDeathSound(float x, float y)
+        { Trigger(SOUND_PLAYER_DEATH, x, y); }
+
+        void PlayBacterSplitSound(float x, float y)
+        { Trigger(SOUND_BACTER_SPLIT, x, y); }
+
+        /// Plays the sounds triggered since the last flush. Call once a frame,
+        /// after all the fixed steps of the frame.
+        void Flush()
         {
-            x *= PositionScale; y *= PositionScale;
-            m_audio->PlaySound(m_plDamageSound, 1.0f, x, y, m_currentTime);
+            for (size_t_32 i = 0; i < SOUND_TYPE_COUNT; i++)
+            {
+                SoundDef &def = m_sounds[i];
+                if (def.m_triggerCount == 0)
+                    continue;
+
+                const bool retriggered = (def.m_lastPlayTime != 0)
+                    && (m_currentTime - def.m_lastPlayTime < def.m_minInterval);
+                if (!retriggered && m_audio->GetPlayingCount(def.m_sound) < def.m_maxInstances)
+                {
+                    // The merged sounds add up in power, not in amplitude.
+                    const float count = float(def.m_triggerCount);
+                    const float volume = def.m_volume * std::sqrt(count);
+                    const float x = def.m_sumX / count * PositionScale;
+                    const float y = def.m_sumY / count * PositionScale;
+                    m_audio->PlaySound(def.m_sound, (volume < 1.0f) ? volume : 1.0f, x, y, m_currentTime);
+                    def.m_lastPlayTime = m_currentTime;
+                }
+
+                def.m_triggerCount = 0;
+                def.m_sumX = def.m_sumY = 0.0f;
+            }
         }
 
-        void PlayPlayerDeathSound(float x, float y)
+    private:
+        void InitSound(SoundType type, SoundHandle sound, float volume,
+                       size_t_32 maxInstances, Time_t minInterval)
         {
-            x *= PositionScale; y *= PositionScale;
-            m_audio->PlaySound(m_plDeathSound, 0.5f, x, y, m_currentTime);
+            SoundDef &def = m_sounds[type];
+            def.m_sound = sound;
+            def.m_volume = volume;
+            def.m_maxInstances = maxInstances;
+            def.m_minInterval = minInterval;
+            def.m_lastPlayTime = 0;
+            def.m_triggerCount = 0;
+            def.m_sumX = def.m_sumY = 0.0f;
         }
 
-        void PlayBacterSplitSound(float x, float y)
+        void Trigger(SoundType type, float x, float y)
         {
-            x *= PositionScale; y *= PositionScale;
-            m_audio->PlaySound(m_bactSplitSound, 0.5f, x, y, m_currentTime);
+            SoundDef &def = m_sounds[type];
+            def.m_triggerCount++;
+            def.m_sumX += x;
+            def.m_sumY += y;
         }
 
     private:
         AudioSystem *m_audio;
-//        MasterCache *m_cache;
         Time_t m_currentTime;
-
-        SoundHandle m_shootSound;
-        SoundHandle m_plDamageSound;
-        SoundHandle m_plDeathSound;
-        SoundHandle m_bactSplitSound;
+        SoundDef m_sounds[SOUND_TYPE_COUNT];
     };
 
 } // bact
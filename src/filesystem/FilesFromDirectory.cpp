@@ -30,7 +30,7 @@ namespace rob
                     if (IsDirectory(filepath.c_str()))
                     {
                         if (recursive)
-                            GetFilesFromDirectoryImpl(filepath, file + "/", files, true);
+                            GetFilesFromDirectoryImpl(filepath + "/", file + "/", files, true);
                     }
                     else
                     {
@@ -0,0 +1,126 @@
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rob
+{
+
+#if defined(_WIN32)
+
+    MappedFile::MappedFile()
+        : m_data(nullptr)
+        , m_size(0)
+        , m_file(INVALID_HANDLE_VALUE)
+        , m_mapping(nullptr)
+    { }
+
+    MappedFile::~MappedFile()
+    { Close(); }
+
+    bool MappedFile::Open(const char * const filename)
+    {
+        Close();
+
+        m_file = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(m_file, &size) || size.QuadPart == 0 || size.HighPart != 0)
+        {
+            Close();
+            return false;
+        }
+        m_size = size.LowPart;
+
+        m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            Close();
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            ::UnmapViewOfFile(m_data);
+        if (m_mapping)
+            ::CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            ::CloseHandle(m_file);
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    MappedFile::MappedFile()
+        : m_data(nullptr)
+        , m_size(0)
+        , m_file(-1)
+    { }
+
+    MappedFile::~MappedFile()
+    { Close(); }
+
+    bool MappedFile::Open(const char * const filename)
+    {
+        Close();
+
+        m_file = ::open(filename, O_RDONLY);
+        if (m_file < 0)
+            return false;
+
+        struct ::stat s;
+        if (::fstat(m_file, &s) != 0 || s.st_size == 0)
+        {
+            Close();
+            return false;
+        }
+        m_size = size_t_32(s.st_size);
+
+        void *data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+        if (data == MAP_FAILED)
+        {
+            Close();
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_data)
+            ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_file >= 0)
+            ::close(m_file);
+        m_data = nullptr;
+        m_size = 0;
+        m_file = -1;
+    }
+
+#endif
+
+} // rob
@@ -0,0 +1,40 @@
+
+#ifndef H_ROB_MAPPED_FILE_H
+#define H_ROB_MAPPED_FILE_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Read only memory mapped file.
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator = (const MappedFile&) = delete;
+        ~MappedFile();
+
+        bool Open(const char * const filename);
+        void Close();
+
+        bool IsOpen() const { return m_data != nullptr; }
+
+        const uint8_t* GetData() const { return m_data; }
+        size_t_32 GetSize() const { return m_size; }
+
+    private:
+        const uint8_t *m_data;
+        size_t_32 m_size;
+    #if defined(_WIN32)
+        void *m_file;
+        void *m_mapping;
+    #else
+        int m_file;
+    #endif
+    };
+
+} // rob
+
+#endif // H_ROB_MAPPED_FILE_H
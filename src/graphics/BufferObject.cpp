@@ -18,6 +18,13 @@ namespace rob
         GL_CHECK;
     }
 
+    BufferObject::BufferObject(BufferObject &&other)
+        : m_object(other.m_object)
+        , m_target(other.m_target)
+        , m_sizeBytes(other.m_sizeBytes)
+        , m_dynamic(other.m_dynamic)
+    { other.m_object = 0; }
+
     BufferObject::~BufferObject()
     {
         ::glDeleteBuffers(1, &m_object);
@@ -12,8 +12,13 @@ namespace rob
     {
     public:
         explicit BufferObject(GLenum target);
+        /// Takes the buffer object from \c other.
+        BufferObject(BufferObject &&other);
         virtual ~BufferObject();
 
+        BufferObject(const BufferObject&) = delete;
+        BufferObject& operator = (const BufferObject&) = delete;
+
         GLuint GetObject() const;
         GLenum GetTarget() const;
 
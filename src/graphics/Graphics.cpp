@@ -16,6 +16,8 @@
 #include "GLCheck.h"
 #include <GL/glew.h>
 
+#include <cstring>
+
 namespace rob
 {
 
@@ -55,7 +57,7 @@ namespace rob
         log::Debug(src, " ", tp, "(", sev, "): ", message, ", ", id);
     }
 
-    Graphics::Graphics(LinearAllocator &alloc)
+    Graphics::Graphics(LinearAllocator &alloc, const GraphicsCapacities &capacities)
         : m_bind()
         , m_state()
         , m_textures()
@@ -65,11 +67,12 @@ namespace rob
         , m_fragmentShaders()
         , m_shaderPrograms()
         , m_uniforms()
+        , m_gl()
+        , m_skipped()
         , m_initialized(false)
         , m_hasDebugOutput(false)
+        , m_hasProgramBinary(false)
     {
-        SetViewport(0, 0, 0, 0);
-
         InitState();
 
     #ifdef ROB_DEBUG
@@ -81,17 +84,26 @@ namespace rob
         }
     #endif // ROB_DEBUG
 
-        ::glEnable(GL_BLEND);
-        ::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_hasProgramBinary = ::glewIsSupported("GL_ARB_get_program_binary");
+
+        SetBlendEnabled(true);
+        SetBlendFunc(BlendFactor::SrcAlpha, BlendFactor::OneMinusSrcAlpha);
 
-        const size_t_32 blockSize = 1024;
-        m_textures.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_vertexBuffers.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_indexBuffers.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_vertexShaders.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_fragmentShaders.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_shaderPrograms.SetMemory(alloc.Allocate(blockSize), blockSize);
-        m_uniforms.SetMemory(alloc.Allocate(blockSize), blockSize);
+        m_textures.SetName("Textures", MemoryTag::Graphics);
+        m_vertexBuffers.SetName("Vertex buffers", MemoryTag::Graphics);
+        m_indexBuffers.SetName("Index buffers", MemoryTag::Graphics);
+        m_vertexShaders.SetName("Vertex shaders", MemoryTag::Graphics);
+        m_fragmentShaders.SetName("Fragment shaders", MemoryTag::Graphics);
+        m_shaderPrograms.SetName("Shader programs", MemoryTag::Graphics);
+        m_uniforms.SetName("Uniforms", MemoryTag::Graphics);
+
+        m_textures.Init(alloc, capacities.m_textures);
+        m_vertexBuffers.Init(alloc, capacities.m_vertexBuffers);
+        m_indexBuffers.Init(alloc, capacities.m_indexBuffers);
+        m_vertexShaders.Init(alloc, capacities.m_vertexShaders);
+        m_fragmentShaders.Init(alloc, capacities.m_fragmentShaders);
+        m_shaderPrograms.Init(alloc, capacities.m_shaderPrograms);
+        m_uniforms.Init(alloc, capacities.m_uniforms);
 
         m_initialized = true;
     }
@@ -104,17 +116,42 @@ namespace rob
         m_bind.indexBuffer = InvalidHandle;
         m_bind.shaderProgram = InvalidHandle;
         m_state = m_bind;
+
+        // Push the whole shadow state to GL, so that the two are in sync
+        // and later changes can be compared against the shadow state.
+        m_gl.viewport = { 0, 0, 0, 0 };
+        ::glViewport(0, 0, 0, 0);
+        m_gl.scissor = { 0, 0, 0, 0 };
+        ::glScissor(0, 0, 0, 0);
+        m_gl.scissorEnabled = false;
+        ::glDisable(GL_SCISSOR_TEST);
+        m_gl.blendEnabled = false;
+        ::glDisable(GL_BLEND);
+        m_gl.blendSrc = BlendFactor::One;
+        m_gl.blendDst = BlendFactor::Zero;
+        ::glBlendFunc(GL_ONE, GL_ZERO);
+        m_gl.clearColor[0] = m_gl.clearColor[1] = m_gl.clearColor[2] = 0.0f;
+        ::glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        m_gl.activeTexture = 0;
+        ::glActiveTexture(GL_TEXTURE0);
+        m_gl.attribsEnabled = 0;
+        for (size_t_32 i = 0; i < MAX_VERTEX_ATTRIBS; i++)
+        {
+            ::glDisableVertexAttribArray(i);
+            m_gl.attribs[i] = { InvalidHandle, 0, 0, 0 };
+        }
+        GL_CHECK;
     }
 
     Graphics::~Graphics()
     {
-        ROB_WARN(m_textures.GetAllocationCount() > 0);
-        ROB_WARN(m_vertexBuffers.GetAllocationCount() > 0);
-        ROB_WARN(m_indexBuffers.GetAllocationCount() > 0);
-        ROB_WARN(m_vertexShaders.GetAllocationCount() > 0);
-        ROB_WARN(m_fragmentShaders.GetAllocationCount() > 0);
-        ROB_WARN(m_shaderPrograms.GetAllocationCount() > 0);
-        ROB_WARN(m_uniforms.GetAllocationCount() > 0);
+        ROB_WARN(m_textures.Size() > 0);
+        ROB_WARN(m_vertexBuffers.Size() > 0);
+        ROB_WARN(m_indexBuffers.Size() > 0);
+        ROB_WARN(m_vertexShaders.Size() > 0);
+        ROB_WARN(m_fragmentShaders.Size() > 0);
+        ROB_WARN(m_shaderPrograms.Size() > 0);
+        ROB_WARN(m_uniforms.Size() > 0);
     }
 
     bool Graphics::IsInitialized() const
@@ -123,28 +160,108 @@ namespace rob
     bool Graphics::HasDebugOutput() const
     { return m_hasDebugOutput; }
 
+    bool Graphics::HasProgramBinary() const
+    { return m_hasProgramBinary; }
+
     void Graphics::SetViewport(int x, int y, int w, int h)
     {
+        const Rect viewport = { x, y, w, h };
+        if (m_gl.viewport == viewport)
+        {
+            m_skipped.m_viewport++;
+            return;
+        }
+        m_gl.viewport = viewport;
         ::glViewport(x, y, w, h);
-        m_viewport.x = x;
-        m_viewport.y = y;
-        m_viewport.w = w;
-        m_viewport.h = h;
+        GL_CHECK;
     }
 
     void Graphics::GetViewport(int *x, int *y, int *w, int *h) const
     {
-        *x = m_viewport.x;
-        *y = m_viewport.y;
-        *w = m_viewport.w;
-        *h = m_viewport.h;
+        *x = m_gl.viewport.x;
+        *y = m_gl.viewport.y;
+        *w = m_gl.viewport.w;
+        *h = m_gl.viewport.h;
+    }
+
+    void Graphics::SetScissorEnabled(bool enabled)
+    {
+        if (m_gl.scissorEnabled == enabled)
+        {
+            m_skipped.m_scissor++;
+            return;
+        }
+        m_gl.scissorEnabled = enabled;
+        if (enabled) ::glEnable(GL_SCISSOR_TEST);
+        else ::glDisable(GL_SCISSOR_TEST);
+        GL_CHECK;
+    }
+
+    void Graphics::SetScissor(int x, int y, int w, int h)
+    {
+        const Rect scissor = { x, y, w, h };
+        if (m_gl.scissor == scissor)
+        {
+            m_skipped.m_scissor++;
+            return;
+        }
+        m_gl.scissor = scissor;
+        ::glScissor(x, y, w, h);
+        GL_CHECK;
+    }
+
+    void Graphics::SetBlendEnabled(bool enabled)
+    {
+        if (m_gl.blendEnabled == enabled)
+        {
+            m_skipped.m_blend++;
+            return;
+        }
+        m_gl.blendEnabled = enabled;
+        if (enabled) ::glEnable(GL_BLEND);
+        else ::glDisable(GL_BLEND);
+        GL_CHECK;
+    }
+
+    static const GLenum gl_blend_factors[] = {
+        [static_cast<int>(BlendFactor::Zero)]               = GL_ZERO,
+        [static_cast<int>(BlendFactor::One)]                = GL_ONE,
+        [static_cast<int>(BlendFactor::SrcColor)]           = GL_SRC_COLOR,
+        [static_cast<int>(BlendFactor::OneMinusSrcColor)]   = GL_ONE_MINUS_SRC_COLOR,
+        [static_cast<int>(BlendFactor::SrcAlpha)]           = GL_SRC_ALPHA,
+        [static_cast<int>(BlendFactor::OneMinusSrcAlpha)]   = GL_ONE_MINUS_SRC_ALPHA,
+        [static_cast<int>(BlendFactor::DstColor)]           = GL_DST_COLOR,
+    };
+
+    void Graphics::SetBlendFunc(BlendFactor src, BlendFactor dst)
+    {
+        if (m_gl.blendSrc == src && m_gl.blendDst == dst)
+        {
+            m_skipped.m_blend++;
+            return;
+        }
+        m_gl.blendSrc = src;
+        m_gl.blendDst = dst;
+        ::glBlendFunc(gl_blend_factors[static_cast<int>(src)],
+                      gl_blend_factors[static_cast<int>(dst)]);
+        GL_CHECK;
     }
 
     void Graphics::Clear()
     { ::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); }
 
     void Graphics::SetClearColor(float r, float g, float b)
-    { ::glClearColor(r, g, b, 1.0f); }
+    {
+        // Compared bitwise, as the color is only ever set from these values.
+        const float color[3] = { r, g, b };
+        if (std::memcmp(m_gl.clearColor, color, sizeof(color)) == 0)
+        {
+            m_skipped.m_clearColor++;
+            return;
+        }
+        std::memcpy(m_gl.clearColor, color, sizeof(color));
+        ::glClearColor(r, g, b, 1.0f);
+    }
 
 
     void Graphics::SetTexture(size_t_32 unit, TextureHandle texture)
@@ -172,16 +289,30 @@ namespace rob
         BindIndexBuffer(m_state.indexBuffer);
     }
 
+    void Graphics::SetActiveTexture(size_t_32 unit)
+    {
+        if (m_gl.activeTexture == unit)
+        {
+            m_skipped.m_activeTexture++;
+            return;
+        }
+        m_gl.activeTexture = unit;
+        ::glActiveTexture(GL_TEXTURE0 + unit);
+        GL_CHECK;
+    }
+
     void Graphics::BindTexture(size_t_32 unit, TextureHandle texture)
     {
         ROB_ASSERT(unit < MAX_TEXTURE_UNITS);
 
         if (m_bind.texture[unit] == texture)
+        {
+            m_skipped.m_texture++;
             return;
+        }
 
         m_bind.texture[unit] = texture;
-        ::glActiveTexture(GL_TEXTURE0 + unit);
-        GL_CHECK;
+        SetActiveTexture(unit);
         if (texture == InvalidHandle)
         {
             ::glBindTexture(GL_TEXTURE_2D, 0);
@@ -198,7 +329,10 @@ namespace rob
     void Graphics::BindVertexBuffer(VertexBufferHandle buffer)
     {
         if (m_bind.vertexBuffer == buffer)
+        {
+            m_skipped.m_vertexBuffer++;
             return;
+        }
 
         m_bind.vertexBuffer = buffer;
         if (buffer == InvalidHandle)
@@ -217,7 +351,10 @@ namespace rob
     void Graphics::BindIndexBuffer(IndexBufferHandle buffer)
     {
         if (m_bind.indexBuffer == buffer)
+        {
+            m_skipped.m_indexBuffer++;
             return;
+        }
 
         m_bind.indexBuffer = buffer;
         if (buffer == InvalidHandle)
@@ -252,6 +389,10 @@ namespace rob
                 GL_CHECK;
             }
         }
+        else
+        {
+            m_skipped.m_shaderProgram++;
+        }
         if (p) p->UpdateUniforms(this);
     }
 
@@ -318,9 +459,33 @@ namespace rob
 
     void Graphics::SetAttrib(size_t_32 attr, size_t_32 size, size_t_32 stride, size_t_32 offset)
     {
-        ROB_ASSERT(attr < 8);
-        ::glEnableVertexAttribArray(attr);
-        GL_CHECK;
+        ROB_ASSERT(attr < MAX_VERTEX_ATTRIBS);
+
+        const uint32_t attrBit = 1u << attr;
+        if (m_gl.attribsEnabled & attrBit)
+        {
+            m_skipped.m_attribArray++;
+        }
+        else
+        {
+            m_gl.attribsEnabled |= attrBit;
+            ::glEnableVertexAttribArray(attr);
+            GL_CHECK;
+        }
+
+        // The attribute pointer refers to the vertex buffer bound at the
+        // time of the call, so the buffer is part of the compared state.
+        Attrib &a = m_gl.attribs[attr];
+        if (a.buffer == m_bind.vertexBuffer && a.size == size &&
+            a.stride == stride && a.offset == offset)
+        {
+            m_skipped.m_attribPointer++;
+            return;
+        }
+        a.buffer = m_bind.vertexBuffer;
+        a.size = size;
+        a.stride = stride;
+        a.offset = offset;
         ::glVertexAttribPointer(attr, size, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
         GL_CHECK;
     }
@@ -359,74 +524,56 @@ namespace rob
     // Textures
 
     TextureHandle Graphics::CreateTexture()
-    {
-        Texture *texture = m_textures.Obtain();
-        return m_textures.IndexOf(texture);
-    }
+    { return m_textures.Create(); }
 
     Texture* Graphics::GetTexture(TextureHandle texture)
     { return m_textures.Get(texture); }
 
     void Graphics::DestroyTexture(TextureHandle texture)
-    { m_textures.Return(GetTexture(texture)); }
+    { m_textures.Destroy(texture); }
 
     // Vertex and index buffers
 
     VertexBufferHandle Graphics::CreateVertexBuffer()
-    {
-        VertexBuffer *buffer = m_vertexBuffers.Obtain();
-        return m_vertexBuffers.IndexOf(buffer);
-    }
+    { return m_vertexBuffers.Create(); }
 
     VertexBuffer* Graphics::GetVertexBuffer(VertexBufferHandle buffer)
     { return m_vertexBuffers.Get(buffer); }
 
     void Graphics::DestroyVertexBuffer(VertexBufferHandle buffer)
-    { m_vertexBuffers.Return(GetVertexBuffer(buffer)); }
+    { m_vertexBuffers.Destroy(buffer); }
 
     IndexBufferHandle Graphics::CreateIndexBuffer()
-    {
-        IndexBuffer *buffer = m_indexBuffers.Obtain();
-        return m_indexBuffers.IndexOf(buffer);
-    }
+    { return m_indexBuffers.Create(); }
 
     IndexBuffer* Graphics::GetIndexBuffer(IndexBufferHandle buffer)
     { return m_indexBuffers.Get(buffer); }
 
     void Graphics::DestroyIndexBuffer(IndexBufferHandle buffer)
-    { m_indexBuffers.Return(GetIndexBuffer(buffer)); }
+    { m_indexBuffers.Destroy(buffer); }
 
     // Shaders
 
     VertexShaderHandle Graphics::CreateVertexShader()
-    {
-        VertexShader *shader = m_vertexShaders.Obtain();
-        return m_vertexShaders.IndexOf(shader);
-    }
+    { return m_vertexShaders.Create(); }
 
     VertexShader* Graphics::GetVertexShader(VertexShaderHandle shader)
     { return m_vertexShaders.Get(shader); }
 
     void Graphics::DestroyVertexShader(VertexShaderHandle shader)
-    { m_vertexShaders.Return(GetVertexShader(shader)); }
+    { m_vertexShaders.Destroy(shader); }
 
     FragmentShaderHandle Graphics::CreateFragmentShader()
-    {
-        FragmentShader *shader = m_fragmentShaders.Obtain();
-        return m_fragmentShaders.IndexOf(shader);
-    }
+    { return m_fragmentShaders.Create(); }
 
     FragmentShader* Graphics::GetFragmentShader(FragmentShaderHandle shader)
     { return m_fragmentShaders.Get(shader); }
 
     void Graphics::DestroyFragmentShader(FragmentShaderHandle shader)
-    { m_fragmentShaders.Return(GetFragmentShader(shader)); }
+    { m_fragmentShaders.Destroy(shader); }
 
     ShaderProgramHandle Graphics::CreateShaderProgram()
-    {
-        ShaderProgram *program = m_shaderPrograms.Obtain();
-        return m_shaderPrograms.IndexOf(program);
-    }
+    { return m_shaderPrograms.Create(); }
 
     ShaderProgram* Graphics::GetShaderProgram(ShaderProgramHandle program)
     { return m_shaderPrograms.Get(program); }
@@ -435,20 +582,21 @@ namespace rob
     {
         ShaderProgram *p = GetShaderProgram(program);
         p->RemoveUniforms(this);
-        m_shaderPrograms.Return(p);
+        m_shaderPrograms.Destroy(program);
     }
 
     // Uniforms
 
     UniformHandle Graphics::CreateUniform(const char *name, UniformType type)
     {
-        Uniform *uniform = m_uniforms.Obtain();
+        const UniformHandle handle = m_uniforms.Create();
+        Uniform *uniform = m_uniforms.Get(handle);
         uniform->m_type         = type;
         uniform->m_generation   = 0;
         uniform->m_references   = 0;
         uniform->m_upload       = Uniform::GetUploadFuncFromType(type);
         CopyStringN(uniform->m_name, name);
-        return m_uniforms.IndexOf(uniform);
+        return handle;
     }
 
     UniformHandle Graphics::CreateGlobalUniform(const char *name, UniformType type)
@@ -465,7 +613,7 @@ namespace rob
     {
         Uniform *u = GetUniform(uniform);
         ROB_WARN(u->m_references > 0);
-        m_uniforms.Return(u);
+        m_uniforms.Destroy(uniform);
     }
 
     void Graphics::AddRefUniform(UniformHandle uniform)
@@ -492,4 +640,21 @@ namespace rob
         }
     }
 
+    const Graphics::SkippedCalls& Graphics::GetSkippedCalls() const
+    { return m_skipped; }
+
+    void Graphics::ResetSkippedCalls()
+    { m_skipped = SkippedCalls(); }
+
+    void Graphics::ReportSkippedCalls() const
+    {
+        log::Info("Skipped redundant GL calls:");
+        log::Info("  viewport: ", m_skipped.m_viewport, ", scissor: ", m_skipped.m_scissor,
+                  ", blend: ", m_skipped.m_blend, ", clear color: ", m_skipped.m_clearColor);
+        log::Info("  active texture: ", m_skipped.m_activeTexture, ", texture: ", m_skipped.m_texture);
+        log::Info("  vertex buffer: ", m_skipped.m_vertexBuffer, ", index buffer: ", m_skipped.m_indexBuffer,
+                  ", program: ", m_skipped.m_shaderProgram);
+        log::Info("  attrib array: ", m_skipped.m_attribArray, ", attrib pointer: ", m_skipped.m_attribPointer);
+    }
+
 } // rob
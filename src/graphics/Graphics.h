@@ -5,7 +5,7 @@
 #include "GraphicsTypes.h"
 #include "../math/Types.h"
 
-#include "../memory/Pool.h"
+#include "../memory/SlotMap.h"
 
 namespace rob
 {
@@ -43,21 +43,60 @@ namespace rob
 //        attrib[8]
 //    };
 
+    /// Initial number of objects of each type. The storage is allocated
+    /// from the allocator given to Graphics and moved to the heap with
+    /// double the capacity, when it runs out.
+    struct GraphicsCapacities
+    {
+        size_t_32 m_textures = 64;
+        size_t_32 m_vertexBuffers = 16;
+        size_t_32 m_indexBuffers = 16;
+        size_t_32 m_vertexShaders = 16;
+        size_t_32 m_fragmentShaders = 16;
+        size_t_32 m_shaderPrograms = 32;
+        size_t_32 m_uniforms = 64;
+    };
+
     class Graphics
     {
     public:
         static const size_t_32 MAX_TEXTURE_UNITS = 8;
+        static const size_t_32 MAX_VERTEX_ATTRIBS = 8;
+
+        /// Counts of GL calls that were skipped, because the requested
+        /// state was already set.
+        struct SkippedCalls
+        {
+            size_t_32 m_viewport;
+            size_t_32 m_scissor;
+            size_t_32 m_blend;
+            size_t_32 m_clearColor;
+            size_t_32 m_activeTexture;
+            size_t_32 m_texture;
+            size_t_32 m_vertexBuffer;
+            size_t_32 m_indexBuffer;
+            size_t_32 m_shaderProgram;
+            size_t_32 m_attribArray;
+            size_t_32 m_attribPointer;
+        };
 
     public:
-        Graphics(LinearAllocator &alloc);
+        Graphics(LinearAllocator &alloc, const GraphicsCapacities &capacities = GraphicsCapacities());
         ~Graphics();
 
         bool IsInitialized() const;
         bool HasDebugOutput() const;
+        bool HasProgramBinary() const;
 
         void SetViewport(int x, int y, int w, int h);
         void GetViewport(int *x, int *y, int *w, int *h) const;
 
+        void SetScissorEnabled(bool enabled);
+        void SetScissor(int x, int y, int w, int h);
+
+        void SetBlendEnabled(bool enabled);
+        void SetBlendFunc(BlendFactor src, BlendFactor dst);
+
         void Clear();
         void SetClearColor(float r, float g, float b);
 
@@ -121,8 +160,13 @@ namespace rob
 
         void AddProgramUniform(ShaderProgramHandle program, UniformHandle uniform);
 
+        const SkippedCalls& GetSkippedCalls() const;
+        void ResetSkippedCalls();
+        void ReportSkippedCalls() const;
+
     private:
         void InitState();
+        void SetActiveTexture(size_t_32 unit);
 
     private:
         struct State
@@ -133,22 +177,48 @@ namespace rob
             ShaderProgramHandle shaderProgram;
         } m_bind, m_state;
 
-        Pool<Texture>       m_textures;
-        Pool<VertexBuffer>  m_vertexBuffers;
-        Pool<IndexBuffer>   m_indexBuffers;
-        Pool<VertexShader>  m_vertexShaders;
-        Pool<FragmentShader>m_fragmentShaders;
-        Pool<ShaderProgram> m_shaderPrograms;
-        Pool<Uniform>       m_uniforms;
+        SlotMap<Texture>            m_textures;
+        SlotMap<VertexBuffer>       m_vertexBuffers;
+        SlotMap<IndexBuffer>        m_indexBuffers;
+        SlotMap<VertexShader>       m_vertexShaders;
+        SlotMap<FragmentShader>     m_fragmentShaders;
+        SlotMap<ShaderProgram>      m_shaderPrograms;
+        SlotMap<Uniform>            m_uniforms;
 
-        bool m_initialized;
-        bool m_hasDebugOutput;
-
-        struct Viewport
+        struct Rect
         {
             int x, y;
             int w, h;
-        } m_viewport;
+
+            bool operator == (const Rect &r) const
+            { return x == r.x && y == r.y && w == r.w && h == r.h; }
+        };
+
+        struct Attrib
+        {
+            VertexBufferHandle buffer;
+            size_t_32 size, stride, offset;
+        };
+
+        /// Shadow copy of the fixed function GL state.
+        struct GLState
+        {
+            Rect viewport;
+            Rect scissor;
+            bool scissorEnabled;
+            bool blendEnabled;
+            BlendFactor blendSrc, blendDst;
+            float clearColor[3];
+            size_t_32 activeTexture;
+            uint32_t attribsEnabled;
+            Attrib attribs[MAX_VERTEX_ATTRIBS];
+        } m_gl;
+
+        SkippedCalls m_skipped;
+
+        bool m_initialized;
+        bool m_hasDebugOutput;
+        bool m_hasProgramBinary;
     };
 
 } // rob
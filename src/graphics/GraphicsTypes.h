@@ -32,6 +32,14 @@ namespace rob
         Vec4, Mat4
     };
 
+    enum class BlendFactor
+    {
+        Zero, One,
+        SrcColor, OneMinusSrcColor,
+        SrcAlpha, OneMinusSrcAlpha,
+        DstColor
+    };
+
 } // rob
 
 #endif // H_ROB_GRAPHICS_TYPES_H
@@ -11,6 +11,11 @@ namespace rob
         , m_compiled(false)
     { m_object = ::glCreateShader(shaderType); }
 
+    Shader::Shader(Shader &&other)
+        : m_object(other.m_object)
+        , m_compiled(other.m_compiled)
+    { other.m_object = 0; }
+
     Shader::~Shader()
     { ::glDeleteShader(m_object); }
 
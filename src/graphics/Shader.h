@@ -12,8 +12,13 @@ namespace rob
     {
     public:
         explicit Shader(GLenum shaderType);
+        /// Takes the shader object from \c other.
+        Shader(Shader &&other);
         virtual ~Shader();
 
+        Shader(const Shader&) = delete;
+        Shader& operator = (const Shader&) = delete;
+
         GLuint GetObject() const;
 
         void SetSource(const char * const source);
@@ -27,6 +27,17 @@ namespace rob
         }
     }
 
+    ShaderProgram::ShaderProgram(ShaderProgram &&other)
+        : m_object(other.m_object)
+        , m_linked(other.m_linked)
+        , m_uniformCount(other.m_uniformCount)
+    {
+        for (size_t_32 i = 0; i < m_uniformCount; i++)
+            m_uniforms[i] = other.m_uniforms[i];
+        other.m_object = 0;
+        other.m_uniformCount = 0;
+    }
+
     ShaderProgram::~ShaderProgram()
     { ::glDeleteProgram(m_object); }
 
@@ -63,18 +74,40 @@ namespace rob
     void ShaderProgram::GetLinkInfo(char *buffer, size_t_32 bufferSize) const
     { ::glGetProgramInfoLog(m_object, bufferSize, nullptr, buffer); }
 
+    void ShaderProgram::SetBinaryRetrievable()
+    { ::glProgramParameteri(m_object, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
+
+    bool ShaderProgram::LoadBinary(GLenum format, const void *data, size_t_32 size)
+    {
+        ::glProgramBinary(m_object, format, data, size);
+        GLint linked = GL_FALSE;
+        ::glGetProgramiv(m_object, GL_LINK_STATUS, &linked);
+        return m_linked = (linked == GL_TRUE) ? true : false;
+    }
+
+    size_t_32 ShaderProgram::GetBinarySize() const
+    {
+        GLint len = 0;
+        ::glGetProgramiv(m_object, GL_PROGRAM_BINARY_LENGTH, &len);
+        return static_cast<size_t_32>(len);
+    }
+
+    size_t_32 ShaderProgram::GetBinary(void *buffer, size_t_32 bufferSize, GLenum *format) const
+    {
+        GLsizei len = 0;
+        ::glGetProgramBinary(m_object, bufferSize, &len, format, buffer);
+        return static_cast<size_t_32>(len);
+    }
+
     bool ShaderProgram::AddUniform(UniformHandle handle, const char *name)
     {
         for (size_t_32 i = 0; i < m_uniformCount; i++)
         {
             UniformInfo &info = m_uniforms[i];
-            // NOTE: Uniform has already been added, or the uniform was
-            // deleted and this is a new uniform with the same handle.
-            // Either way we just skip adding it again to the uniforms list.
-            // If it really was a new uniform, then it should fail in the
-            // equality test. This should be implemented as Handle = {index,generation}.
-            // Now the potentially new uniform would be added and it's reference
-            // count updated.
+            // NOTE: Handles carry the generation of the pool slot, so a
+            // uniform that reuses the slot of a deleted uniform gets a
+            // different handle. Equal handle means the uniform has already
+            // been added.
             ROB_WARN(info.handle == handle);
             if (info.handle == handle)
             {
@@ -109,14 +142,21 @@ namespace rob
         }
     }
 
-    void ShaderProgram::RemoveUniforms(Graphics *graphics)
+    size_t_32 ShaderProgram::GetUniformCount() const
+    { return m_uniformCount; }
+
+    void ShaderProgram::RemoveUniforms(Graphics *graphics, size_t_32 first)
     {
-        for (size_t_32 i = 0; i < m_uniformCount; i++)
+        for (size_t_32 i = first; i < m_uniformCount; i++)
         {
             UniformInfo &info = m_uniforms[i];
             graphics->DecRefUniform(info.handle);
+            info.handle = InvalidHandle;
+            info.location = -1;
+            info.generation = -1;
         }
-        m_uniformCount = 0;
+        if (first < m_uniformCount)
+            m_uniformCount = first;
     }
 
     GLint ShaderProgram::GetLocation(const char *name) const
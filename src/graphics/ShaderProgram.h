@@ -17,8 +17,13 @@ namespace rob
     {
     public:
         ShaderProgram();
+        /// Takes the program object and the uniforms from \c other.
+        ShaderProgram(ShaderProgram &&other);
         ~ShaderProgram();
 
+        ShaderProgram(const ShaderProgram&) = delete;
+        ShaderProgram& operator = (const ShaderProgram&) = delete;
+
         GLuint GetObject() const;
 
         void SetShaders(VertexShader *vertexShader, FragmentShader *fragmentShader);
@@ -29,6 +34,16 @@ namespace rob
         size_t_32 GetLinkInfoSize() const;
         void GetLinkInfo(char *buffer, size_t_32 bufferSize) const;
 
+        /// Hints that the program binary will be retrieved after linking.
+        /// Requires GL_ARB_get_program_binary.
+        void SetBinaryRetrievable();
+        /// Loads a program binary retrieved earlier with GetBinary. Returns false, if
+        /// the binary was rejected (e.g. the driver has changed).
+        bool LoadBinary(GLenum format, const void *data, size_t_32 size);
+        size_t_32 GetBinarySize() const;
+        /// Retrieves the program binary. Returns the size of the binary written to buffer.
+        size_t_32 GetBinary(void *buffer, size_t_32 bufferSize, GLenum *format) const;
+
         /// Adds the uniform \c handle to the shader program's uniforms.
         /// Returns true, if the uniform was added, false otherwise.
         bool AddUniform(UniformHandle handle, const char *name);
@@ -37,9 +52,12 @@ namespace rob
         /// The program must be bind before calling.
         void UpdateUniforms(Graphics *graphics);
 
+        size_t_32 GetUniformCount() const;
+
         /// Removes the uniforms this shader has decreasing the reference
         /// count for those uniforms (and thus possibly destroying them).
-        void RemoveUniforms(Graphics *graphics);
+        /// The uniforms added before the index \c first are kept.
+        void RemoveUniforms(Graphics *graphics, size_t_32 first = 0);
 
     private:
         GLint GetLocation(const char *name) const;
@@ -17,6 +17,13 @@ namespace rob
         GL_CHECK;
     }
 
+    Texture::Texture(Texture &&other)
+        : m_object(other.m_object)
+        , m_width(other.m_width)
+        , m_height(other.m_height)
+        , m_format(other.m_format)
+    { other.m_object = 0; }
+
     Texture::~Texture()
     {
         ::glDeleteTextures(1, &m_object);
@@ -28,7 +35,7 @@ namespace rob
 
     static const GLenum gl_formats[] = {
         [0] = GL_RGB,
-        [1] = GL_RGB,
+        [Texture::FMT_LUMINANCE] = GL_LUMINANCE,
         [2] = GL_RGB,
         [Texture::FMT_RGB] = GL_RGB,
         [Texture::FMT_RGBA] = GL_RGBA,
@@ -42,6 +49,9 @@ namespace rob
 
         const GLint internalFmt = static_cast<GLint>(fmt);
         const GLenum format = gl_formats[fmt];
+        // Single channel rows are not necessarily aligned to four bytes.
+        ::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GL_CHECK;
         ::glTexImage2D(GL_TEXTURE_2D, 0, internalFmt, w, h, 0, format, GL_UNSIGNED_BYTE, data);
         GL_CHECK;
         ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);//GL_NEAREST);
@@ -50,6 +60,23 @@ namespace rob
         GL_CHECK;
     }
 
+    void Texture::TexMipImage(size_t_32 level, size_t_32 w, size_t_32 h, const void * const data)
+    {
+        const GLint internalFmt = static_cast<GLint>(m_format);
+        const GLenum format = gl_formats[m_format];
+        ::glTexImage2D(GL_TEXTURE_2D, level, internalFmt, w, h, 0, format, GL_UNSIGNED_BYTE, data);
+        GL_CHECK;
+    }
+
+    void Texture::SetMipLevels(size_t_32 count)
+    {
+        ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1);
+        GL_CHECK;
+        ::glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                          (count > 1) ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        GL_CHECK;
+    }
+
     size_t_32 Texture::GetWidth() const
     { return m_width; }
 
@@ -13,13 +13,19 @@ namespace rob
     public:
         enum Format
         {
+            FMT_LUMINANCE = 1,
             FMT_RGB = 3,
             FMT_RGBA = 4
         };
     public:
         Texture();
+        /// Takes the texture object from \c other.
+        Texture(Texture &&other);
         ~Texture();
 
+        Texture(const Texture&) = delete;
+        Texture& operator = (const Texture&) = delete;
+
         GLuint GetObject() const;
 
         /// Sets the texture image using the data in internal format fmt.
@@ -28,6 +34,13 @@ namespace rob
         /// \pre This texture must be bind to the graphics context before calling this method.
         void TexImage(size_t_32 w, size_t_32 h, Format fmt, const void * const data);
 
+        /// Sets the image of a mip level in the format set by TexImage.
+        /// \pre This texture must be bind to the graphics context before calling this method.
+        void TexMipImage(size_t_32 level, size_t_32 w, size_t_32 h, const void * const data);
+        /// Sets the number of mip levels used, including the base level.
+        /// \pre This texture must be bind to the graphics context before calling this method.
+        void SetMipLevels(size_t_32 count);
+
         size_t_32 GetWidth() const;
         size_t_32 GetHeight() const;
 
@@ -2,6 +2,10 @@
 #include <SDL2/SDL.h>
 
 #include "bacteroids/BacteroidsGame.h"
+#include "audio/MixerBenchmark.h"
+#include "memory/PoolBenchmark.h"
+
+#include <cstring>
 
 #ifdef ROB_DEBUG
 #include "resource/Builder/MasterBuilder.h"
@@ -11,6 +15,17 @@ int main(int argc, char *argv[]) __attribute__((force_align_arg_pointer));
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::strcmp(argv[1], "--mixer-benchmark") == 0)
+    {
+        rob::RunMixerBenchmark();
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--pool-benchmark") == 0)
+    {
+        rob::RunPoolBenchmark();
+        return 0;
+    }
+
 #ifdef ROB_DEBUG
     rob::MasterBuilder builder;
     builder.Build("data_source", "data");
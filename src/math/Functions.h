@@ -51,6 +51,12 @@ namespace rob
         return Max(a, Min(x, b));
     }
 
+    template <class V, class T>
+    inline V Lerp(const V &a, const V &b, T t)
+    {
+        return a + (b - a) * t;
+    }
+
     template <class T>
     inline T Sqrt(T x)
     {
@@ -0,0 +1,67 @@
+
+#include "AtomicFreelist.h"
+#include "../Assert.h"
+
+namespace rob
+{
+
+    AtomicFreelist::AtomicFreelist()
+        : m_head(MakeHead(NONE, 0))
+        , m_links(nullptr)
+    { }
+
+    void AtomicFreelist::Init(std::atomic<uint32_t> *links)
+    {
+        m_links = links;
+        m_head.store(MakeHead(NONE, 0), std::memory_order_relaxed);
+    }
+
+    void AtomicFreelist::AddElements(uint32_t first, uint32_t count)
+    {
+        ROB_ASSERT(m_links != nullptr);
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t next = uint32_t(head);
+        // Link in reverse, so that the lowest index is obtained first.
+        for (uint32_t i = first + count; i > first; i--)
+        {
+            m_links[i - 1].store(next, std::memory_order_relaxed);
+            next = i - 1;
+        }
+        m_head.store(MakeHead(next, uint32_t(head >> 32) + 1), std::memory_order_release);
+    }
+
+    uint32_t AtomicFreelist::Obtain()
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint32_t index = uint32_t(head);
+            if (index == NONE)
+                return NONE;
+
+            // The link may be stale, if another thread obtains the element
+            // first, but then the tag has changed and the exchange fails.
+            const uint32_t next = m_links[index].load(std::memory_order_relaxed);
+            const uint64_t newHead = MakeHead(next, uint32_t(head >> 32) + 1);
+            if (m_head.compare_exchange_weak(head, newHead,
+                    std::memory_order_acquire, std::memory_order_acquire))
+            {
+                return index;
+            }
+        }
+    }
+
+    void AtomicFreelist::Return(uint32_t index)
+    {
+        ROB_ASSERT(index != NONE);
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        uint64_t newHead;
+        do
+        {
+            m_links[index].store(uint32_t(head), std::memory_order_relaxed);
+            newHead = MakeHead(index, uint32_t(head >> 32) + 1);
+        } while (!m_head.compare_exchange_weak(head, newHead,
+                    std::memory_order_release, std::memory_order_relaxed));
+    }
+
+} // rob
@@ -0,0 +1,51 @@
+
+#ifndef H_ROB_ATOMIC_FREELIST_H
+#define H_ROB_ATOMIC_FREELIST_H
+
+#include "../Types.h"
+
+#include <atomic>
+
+namespace rob
+{
+
+    /// Lock-free free list of element indices for any number of threads.
+    /// The head packs the first index with a tag that changes on every
+    /// update, so that a compare-exchange fails, if the head was obtained
+    /// and returned in between (the ABA problem). The links are kept apart
+    /// from the elements, because a thread may read the link of an element
+    /// that another thread has just obtained and is writing to.
+    class AtomicFreelist
+    {
+        static const size_t_32 CACHE_LINE_SIZE = 64;
+
+    public:
+        static const uint32_t NONE = ~0u;
+
+    public:
+        AtomicFreelist();
+        AtomicFreelist(const AtomicFreelist&) = delete;
+        AtomicFreelist& operator = (const AtomicFreelist&) = delete;
+
+        /// Sets the links of the elements. The list is empty after Init.
+        void Init(std::atomic<uint32_t> *links);
+
+        /// Adds the indices [first, first + count) to the list. Not thread safe.
+        void AddElements(uint32_t first, uint32_t count);
+
+        /// Returns the index of a free element, or NONE if the list is empty.
+        uint32_t Obtain();
+        void Return(uint32_t index);
+
+    private:
+        static uint64_t MakeHead(uint32_t index, uint32_t tag)
+        { return (uint64_t(tag) << 32) | index; }
+
+    private:
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head;
+        std::atomic<uint32_t> *m_links;
+    };
+
+} // rob
+
+#endif // H_ROB_ATOMIC_FREELIST_H
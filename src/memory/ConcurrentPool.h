@@ -0,0 +1,188 @@
+
+#ifndef H_ROB_CONCURRENT_POOL_H
+#define H_ROB_CONCURRENT_POOL_H
+
+#include "AtomicFreelist.h"
+#include "LinearAllocator.h"
+#include "MemoryTracker.h"
+#include "../Assert.h"
+
+#include <new>
+
+namespace rob
+{
+
+    /// Pool of objects that can be obtained and returned from many threads.
+    /// Each thread works through its own ThreadCache, and the cache trades
+    /// whole batches of free objects with the shared lock-free list, so the
+    /// threads touch the shared state only once per BATCH_SIZE objects.
+    ///
+    /// The objects held by a cache are not available to the other threads,
+    /// so the pool may run out before all of its objects are in use. The
+    /// memory reports show only the capacity of the pool.
+    template <class T>
+    class ConcurrentPool
+    {
+    public:
+        static const uint32_t BATCH_SIZE = 32;
+
+        /// The free objects of one thread. Must not be shared between
+        /// threads, and must be flushed before it is destroyed.
+        class ThreadCache
+        {
+        public:
+            ThreadCache()
+                : m_obtainHead(AtomicFreelist::NONE)
+                , m_returnHead(AtomicFreelist::NONE)
+                , m_returnCount(0)
+                , m_allocations(0)
+            { }
+
+            ThreadCache(const ThreadCache&) = delete;
+            ThreadCache& operator = (const ThreadCache&) = delete;
+
+            ~ThreadCache()
+            {
+                ROB_ASSERT(m_obtainHead == AtomicFreelist::NONE);
+                ROB_ASSERT(m_returnHead == AtomicFreelist::NONE);
+            }
+
+        private:
+            friend class ConcurrentPool;
+
+            /// Chain of free objects to obtain from.
+            uint32_t m_obtainHead;
+            /// Chain of returned objects, given back as a batch when full.
+            uint32_t m_returnHead;
+            uint32_t m_returnCount;
+            int32_t m_allocations;
+        };
+
+    public:
+        ConcurrentPool()
+            : m_objects(nullptr)
+            , m_links(nullptr)
+            , m_capacity(0)
+            , m_batches()
+            , m_allocations(0)
+        { }
+
+        ConcurrentPool(const ConcurrentPool&) = delete;
+        ConcurrentPool& operator = (const ConcurrentPool&) = delete;
+
+        ~ConcurrentPool()
+        { ROB_ASSERT(m_allocations.load(std::memory_order_relaxed) == 0); }
+
+        /// Names the pool in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        { ROB_MEMORY_TRACK(m_stats.SetName(name, tag)); }
+
+        /// Allocates the storage for \c capacity objects from \c alloc.
+        /// Not thread safe.
+        void Init(LinearAllocator &alloc, size_t_32 capacity)
+        {
+            ROB_ASSERT(m_capacity == 0);
+            ROB_ASSERT(capacity > 0 && capacity < AtomicFreelist::NONE);
+
+            ROB_MEMORY_TRACK(const size_t_32 storageStart = alloc.GetAllocatedSize());
+            m_objects = alloc.AllocateArray<T>(capacity);
+            m_links = alloc.AllocateArray<uint32_t>(capacity);
+            std::atomic<uint32_t> *batchLinks = alloc.AllocateArray<std::atomic<uint32_t>>(capacity);
+            for (size_t_32 i = 0; i < capacity; i++)
+                new (batchLinks + i) std::atomic<uint32_t>(AtomicFreelist::NONE);
+            m_batches.Init(batchLinks);
+            m_capacity = capacity;
+
+            // Return the batches in reverse, so that the lowest indices are
+            // obtained first.
+            const uint32_t lastBatch = (capacity - 1) / BATCH_SIZE * BATCH_SIZE;
+            for (uint32_t first = lastBatch + BATCH_SIZE; first > 0; first -= BATCH_SIZE)
+            {
+                const uint32_t start = first - BATCH_SIZE;
+                const uint32_t end = (start + BATCH_SIZE < capacity) ? start + BATCH_SIZE : capacity;
+                for (uint32_t i = start; i < end - 1; i++)
+                    m_links[i] = i + 1;
+                m_links[end - 1] = AtomicFreelist::NONE;
+                m_batches.Return(start);
+            }
+            ROB_MEMORY_TRACK(m_stats.SetCapacity(alloc.GetAllocatedSize() - storageStart));
+        }
+
+        size_t_32 GetCapacity() const
+        { return m_capacity; }
+
+        /// Returns nullptr, if neither the cache nor the pool has free objects.
+        T* Obtain(ThreadCache &cache)
+        {
+            if (cache.m_obtainHead == AtomicFreelist::NONE)
+            {
+                if (cache.m_returnHead != AtomicFreelist::NONE)
+                {
+                    cache.m_obtainHead = cache.m_returnHead;
+                    cache.m_returnHead = AtomicFreelist::NONE;
+                    cache.m_returnCount = 0;
+                }
+                else
+                {
+                    cache.m_obtainHead = m_batches.Obtain();
+                    if (cache.m_obtainHead == AtomicFreelist::NONE)
+                        return nullptr;
+                }
+            }
+
+            const uint32_t index = cache.m_obtainHead;
+            cache.m_obtainHead = m_links[index];
+            cache.m_allocations++;
+            return new (m_objects + index) T();
+        }
+
+        void Return(ThreadCache &cache, T *object)
+        {
+            ROB_ASSERT(m_objects <= object && object < m_objects + m_capacity);
+            object->~T();
+
+            const uint32_t index = static_cast<uint32_t>(object - m_objects);
+            m_links[index] = cache.m_returnHead;
+            cache.m_returnHead = index;
+            cache.m_allocations--;
+            if (++cache.m_returnCount == BATCH_SIZE)
+            {
+                m_batches.Return(cache.m_returnHead);
+                cache.m_returnHead = AtomicFreelist::NONE;
+                cache.m_returnCount = 0;
+            }
+        }
+
+        /// Gives the free objects of the cache back to the pool. Call before
+        /// the thread owning the cache exits.
+        void Flush(ThreadCache &cache)
+        {
+            if (cache.m_obtainHead != AtomicFreelist::NONE)
+                m_batches.Return(cache.m_obtainHead);
+            if (cache.m_returnHead != AtomicFreelist::NONE)
+                m_batches.Return(cache.m_returnHead);
+            cache.m_obtainHead = AtomicFreelist::NONE;
+            cache.m_returnHead = AtomicFreelist::NONE;
+            cache.m_returnCount = 0;
+
+            m_allocations.fetch_add(cache.m_allocations, std::memory_order_relaxed);
+            cache.m_allocations = 0;
+        }
+
+    private:
+        T *m_objects;
+        /// Links the free objects of a batch.
+        uint32_t *m_links;
+        size_t_32 m_capacity;
+        /// The first objects of the free batches.
+        AtomicFreelist m_batches;
+        /// Updated when the caches are flushed.
+        std::atomic<int32_t> m_allocations;
+    #if defined(ROB_MEMORY_TRACKING)
+        AllocatorStats m_stats;
+    #endif
+    };
+
+} // rob
+
+#endif // H_ROB_CONCURRENT_POOL_H
@@ -0,0 +1,36 @@
+
+#include "FrameAllocator.h"
+
+namespace rob
+{
+
+    FrameAllocator::FrameAllocator()
+        : m_buffers()
+        , m_current(0)
+        , m_peakSize(0)
+    { }
+
+    void FrameAllocator::SetMemory(void *start, size_t_32 size)
+    {
+        const size_t_32 frameSize = size / 2;
+        char *memory = static_cast<char*>(start);
+        m_buffers[0].SetMemory(memory, frameSize);
+        m_buffers[1].SetMemory(memory + frameSize, frameSize);
+    }
+
+    void FrameAllocator::BeginFrame()
+    {
+        const size_t_32 used = m_buffers[m_current].GetAllocatedSize();
+        if (used > m_peakSize) m_peakSize = used;
+
+        m_current ^= 1;
+        m_buffers[m_current].Reset();
+    }
+
+    size_t_32 FrameAllocator::GetPeakSize() const
+    {
+        const size_t_32 used = m_buffers[m_current].GetAllocatedSize();
+        return (used > m_peakSize) ? used : m_peakSize;
+    }
+
+} // rob
@@ -0,0 +1,56 @@
+
+#ifndef H_ROB_FRAME_ALLOCATOR_H
+#define H_ROB_FRAME_ALLOCATOR_H
+
+#include "LinearAllocator.h"
+
+namespace rob
+{
+
+    /// Double-buffered allocator for transient data. The allocations made
+    /// during a frame stay valid until the end of the next frame, so data
+    /// can be handed over to the next frame without copying or freeing it.
+    /// The destructors of the objects allocated are not called.
+    class FrameAllocator
+    {
+    public:
+        FrameAllocator();
+        FrameAllocator(const FrameAllocator&) = delete;
+        FrameAllocator& operator = (const FrameAllocator&) = delete;
+
+        /// Splits the memory to the two frame buffers.
+        void SetMemory(void *start, size_t_32 size);
+        /// Names the frame buffers in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        {
+            m_buffers[0].SetName(name, tag);
+            m_buffers[1].SetName(name, tag);
+        }
+
+        /// Swaps the buffers and frees the allocations made two frames ago.
+        void BeginFrame();
+
+        /// Returns the allocator of the current frame.
+        LinearAllocator& GetAllocator() { return m_buffers[m_current]; }
+
+        void* Allocate(size_t_32 size, size_t_32 alignment)
+        { return GetAllocator().Allocate(size, alignment); }
+
+        template <class T>
+        T* AllocateArray(size_t_32 count)
+        { return GetAllocator().AllocateArray<T>(count); }
+
+        /// Returns the largest amount of memory used by a frame.
+        size_t_32 GetPeakSize() const;
+        /// Returns the memory available to a frame.
+        size_t_32 GetFrameSize() const { return m_buffers[0].GetTotalSize(); }
+
+    private:
+        LinearAllocator m_buffers[2];
+        size_t_32 m_current;
+        size_t_32 m_peakSize;
+    };
+
+} // rob
+
+#endif // H_ROB_FRAME_ALLOCATOR_H
@@ -7,15 +7,23 @@ namespace rob
 
     Freelist::Freelist()
         : m_next(nullptr)
+    #if defined(ROB_MEMORY_TRACKING)
+        , m_elementSize(0)
+        , m_stats()
+    #endif
     { }
 
     void* Freelist::Obtain()
     {
         if (m_next == nullptr)
+        {
+            ROB_MEMORY_TRACK(m_stats.OnFail());
             return nullptr;
+        }
 
         Freelist *head = m_next;
         m_next = head->m_next;
+        ROB_MEMORY_TRACK(m_stats.OnAllocate(m_elementSize));
         return static_cast<void*>(head);
     }
 
@@ -24,6 +32,7 @@ namespace rob
         Freelist *head = static_cast<Freelist*>(ptr);
         head->m_next = m_next;
         m_next = head;
+        ROB_MEMORY_TRACK(m_stats.OnFree(m_elementSize));
     }
 
     char* Freelist::AddElements(void *start, size_t_32 size, size_t_32 elementSize, size_t_32 elementAlign)
@@ -39,9 +48,15 @@ namespace rob
         char *s = it;
         while (it + elementSize <= end)
         {
-            Return(static_cast<void*>(it));
+            Freelist *head = reinterpret_cast<Freelist*>(it);
+            head->m_next = m_next;
+            m_next = head;
             it += alignedSize;
         }
+    #if defined(ROB_MEMORY_TRACKING)
+        m_elementSize = alignedSize;
+        m_stats.AddCapacity(static_cast<size_t_32>(it - s));
+    #endif
         return s;
     }
 
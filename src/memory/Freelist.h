@@ -2,6 +2,7 @@
 #ifndef H_ROB_FREELIST_H
 #define H_ROB_FREELIST_H
 
+#include "MemoryTracker.h"
 #include "../Types.h"
 
 namespace rob
@@ -11,6 +12,12 @@ namespace rob
     {
     public:
         Freelist();
+        Freelist(const Freelist&) = delete;
+        Freelist& operator = (const Freelist&) = delete;
+
+        /// Names the free list in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        { ROB_MEMORY_TRACK(m_stats.SetName(name, tag)); }
 
         void* Obtain();
         void Return(void *ptr);
@@ -19,6 +26,10 @@ namespace rob
 
     private:
         Freelist *m_next;
+    #if defined(ROB_MEMORY_TRACKING)
+        size_t_32 m_elementSize;
+        AllocatorStats m_stats;
+    #endif
     };
 
 } // rob
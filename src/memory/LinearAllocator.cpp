@@ -1,7 +1,9 @@
 
 #include "LinearAllocator.h"
 #include "PtrAlign.h"
+#include "VirtualMemory.h"
 #include "../Assert.h"
+#include "../Log.h"
 
 namespace rob
 {
@@ -11,6 +13,10 @@ namespace rob
         , m_myMemory(nullptr)
         , m_head(nullptr)
         , m_end(nullptr)
+        , m_committed(nullptr)
+        , m_commitGranularity(0)
+        , m_reserved(false)
+        , m_prefault(false)
     { }
 
     LinearAllocator::LinearAllocator(size_t_32 size)
@@ -18,17 +24,28 @@ namespace rob
         , m_myMemory(m_start)
         , m_head(m_start)
         , m_end(m_start + size)
-    { }
+        , m_committed(m_end)
+        , m_commitGranularity(0)
+        , m_reserved(false)
+        , m_prefault(false)
+    { ROB_MEMORY_TRACK(m_stats.SetCapacity(size)); }
 
     LinearAllocator::LinearAllocator(void *start, size_t_32 size)
         : m_start(static_cast<char*>(start))
         , m_myMemory(nullptr)
         , m_head(m_start)
         , m_end(m_head + size)
-    { }
+        , m_committed(m_end)
+        , m_commitGranularity(0)
+        , m_reserved(false)
+        , m_prefault(false)
+    { ROB_MEMORY_TRACK(m_stats.SetCapacity(size)); }
 
     LinearAllocator::~LinearAllocator()
-    { delete[] m_myMemory; }
+    {
+        Release();
+        delete[] m_myMemory;
+    }
 
     void LinearAllocator::SetMemory(void *start, size_t_32 size)
     {
@@ -37,6 +54,125 @@ namespace rob
         m_myMemory = nullptr;
         m_head = m_start;
         m_end = m_head + size;
+        m_committed = m_end;
+        ROB_MEMORY_TRACK(m_stats.SetCapacity(size));
+    }
+
+    bool LinearAllocator::AllocateMemory(size_t_32 size)
+    {
+        ROB_ASSERT(m_head == nullptr);
+        char *memory = new (std::nothrow) char[size];
+        if (!memory)
+        {
+            log::Error("Could not allocate ", size, " B of memory");
+            return false;
+        }
+        SetMemory(memory, size);
+        m_myMemory = memory;
+        return true;
+    }
+
+    bool LinearAllocator::Reserve(size_t_32 size, const VirtualMemoryOptions &options)
+    {
+        ROB_ASSERT(m_head == nullptr);
+        ROB_ASSERT((options.m_commitGranularity & (options.m_commitGranularity - 1)) == 0);
+
+        const size_t_32 pageSize = vm::GetPageSize();
+        char *memory = nullptr;
+        if (options.m_largePages)
+        {
+            const size_t_32 largePageSize = vm::GetLargePageSize();
+            if (largePageSize > 0)
+            {
+                memory = static_cast<char*>(vm::AllocateLarge(align(size, largePageSize)));
+                if (memory) size = align(size, largePageSize);
+            }
+            if (!memory)
+                log::Warning("Large pages are not available, reserving ", size, " B with normal pages");
+        }
+        const bool largePages = (memory != nullptr);
+        if (!memory)
+        {
+            size = align(size, pageSize);
+            memory = static_cast<char*>(vm::Reserve(size));
+            if (!memory)
+            {
+                log::Error("Could not reserve ", size, " B of address space");
+                return false;
+            }
+        }
+
+        m_start = memory;
+        m_myMemory = nullptr;
+        m_head = m_start;
+        m_end = m_start + size;
+        m_reserved = true;
+        m_prefault = options.m_prefault;
+        m_commitGranularity = align(options.m_commitGranularity, pageSize);
+        if (m_commitGranularity < pageSize)
+            m_commitGranularity = pageSize;
+
+        if (largePages)
+        {
+            // The large pages are committed when mapped.
+            m_committed = m_end;
+            if (m_prefault) vm::Prefault(m_start, size);
+            ROB_MEMORY_TRACK(m_stats.SetCapacity(size));
+            return true;
+        }
+
+        m_committed = m_start;
+        ROB_MEMORY_TRACK(m_stats.SetCapacity(0));
+        if (options.m_initialCommit > 0 && !Commit(m_start + options.m_initialCommit, options.m_initialCommit))
+        {
+            Release();
+            return false;
+        }
+        return true;
+    }
+
+    bool LinearAllocator::Commit(const char *end, size_t_32 requested)
+    {
+        if (!m_reserved)
+            return false;
+
+        const char *name = "LinearAllocator";
+        ROB_MEMORY_TRACK(name = m_stats.GetName());
+        if (end > m_end || end < m_start)
+        {
+            log::Error(name, ": the reserve of ", GetTotalSize(), " B is exhausted, ",
+                       requested, " B requested with ", GetAllocatedSize(), " B in use");
+            ReportAllocatorUsage();
+            return false;
+        }
+
+        const size_t_32 committed = GetCommittedSize();
+        size_t_32 newCommitted = static_cast<size_t_32>(align(end - m_start, m_commitGranularity));
+        if (newCommitted > GetTotalSize())
+            newCommitted = GetTotalSize();
+
+        if (!vm::Commit(m_start + committed, newCommitted - committed))
+        {
+            log::Error(name, ": could not commit ", newCommitted - committed, " B with ",
+                       committed, " B committed");
+            return false;
+        }
+        if (m_prefault)
+            vm::Prefault(m_start + committed, newCommitted - committed);
+
+        m_committed = m_start + newCommitted;
+        ROB_MEMORY_TRACK(m_stats.SetCapacity(newCommitted));
+        return true;
+    }
+
+    void LinearAllocator::Release()
+    {
+        if (!m_reserved)
+            return;
+        vm::Release(m_start, GetTotalSize());
+        m_start = m_head = nullptr;
+        m_end = m_committed = nullptr;
+        m_reserved = false;
     }
 
     size_t_32 LinearAllocator::GetAllocatedSize() const
@@ -45,25 +181,50 @@ namespace rob
     size_t_32 LinearAllocator::GetTotalSize() const
     { return static_cast<size_t_32>(m_end - m_start); }
 
+    size_t_32 LinearAllocator::GetCommittedSize() const
+    { return static_cast<size_t_32>(m_committed - m_start); }
+
     void* LinearAllocator::Allocate(size_t_32 size)
     {
         char *ptr = m_head;
-        if (ptr + size > m_end)
+        if (ptr + size > m_committed && !Commit(ptr + size, size))
+        {
+            ROB_MEMORY_TRACK(m_stats.OnFail());
             return nullptr;
+        }
         m_head = ptr + size;
+        ROB_MEMORY_TRACK(m_stats.OnAllocate(size));
         return ptr;
     }
 
     void* LinearAllocator::Allocate(size_t_32 size, size_t_32 alignment)
     {
         char *ptr = ptr_align(m_head, alignment);
-        if (ptr + size > m_end)
+        if (ptr + size > m_committed && !Commit(ptr + size, size))
+        {
+            ROB_MEMORY_TRACK(m_stats.OnFail());
             return nullptr;
+        }
+        // The alignment padding is counted as used.
+        ROB_MEMORY_TRACK(m_stats.OnAllocate(static_cast<size_t_32>(ptr + size - m_head)));
         m_head = ptr + size;
         return ptr;
     }
 
     void LinearAllocator::Reset()
-    { m_head = m_start; }
+    {
+        m_head = m_start;
+        ROB_MEMORY_TRACK(m_stats.SetCurrent(0));
+    }
+
+    LinearAllocator::Marker LinearAllocator::GetMarker() const
+    { return GetAllocatedSize(); }
+
+    void LinearAllocator::Rewind(Marker marker)
+    {
+        ROB_ASSERT(marker <= GetAllocatedSize());
+        m_head = m_start + marker;
+        ROB_MEMORY_TRACK(m_stats.SetCurrent(marker));
+    }
 
 } // rob
@@ -4,6 +4,7 @@
 
 #include "../Types.h"
 #include "PtrAlign.h"
+#include "MemoryTracker.h"
 
 #include <new>
 #include <functional>
@@ -11,9 +12,26 @@
 namespace rob
 {
 
+    /// Options for the LinearAllocator backed by reserved virtual memory.
+    struct VirtualMemoryOptions
+    {
+        /// Bytes committed when the memory is reserved.
+        size_t_32 m_initialCommit = 0;
+        /// The commits are rounded up to a multiple of this. At least a page.
+        size_t_32 m_commitGranularity = 64 * 1024;
+        /// Maps the whole reserve with large pages up front, if possible.
+        bool m_largePages = false;
+        /// Touches the pages when they are committed, for the arenas that
+        /// must not fault during a frame.
+        bool m_prefault = false;
+    };
+
     class LinearAllocator
     {
     public:
+        /// Position of the allocation head.
+        typedef size_t_32 Marker;
+
         LinearAllocator(const LinearAllocator &) = delete;
         LinearAllocator(LinearAllocator &) = delete;
         LinearAllocator& operator = (LinearAllocator &) = delete;
@@ -24,8 +42,23 @@ namespace rob
         ~LinearAllocator();
 
         void SetMemory(void *start, size_t_32 size);
+        /// Allocates \c size bytes from the heap, owned by the allocator.
+        /// Returns false, if the memory could not be allocated.
+        bool AllocateMemory(size_t_32 size);
+        /// Reserves \c size bytes of address space and commits the pages on
+        /// demand, as the allocations reach them. Allocations beyond the
+        /// reserve fail and are logged. Returns false, if the address space
+        /// could not be reserved.
+        bool Reserve(size_t_32 size, const VirtualMemoryOptions &options = VirtualMemoryOptions());
+        /// Names the allocator in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        { ROB_MEMORY_TRACK(m_stats.SetName(name, tag)); }
+
         size_t_32 GetAllocatedSize() const;
         size_t_32 GetTotalSize() const;
+        /// Returns the bytes backed by memory. Equals the total size, unless
+        /// the memory is reserved.
+        size_t_32 GetCommittedSize() const;
 
         void* Allocate(size_t_32 size);
         void* Allocate(size_t_32 size, size_t_32 alignment);
@@ -39,6 +72,11 @@ namespace rob
 
         void Reset();
 
+        Marker GetMarker() const;
+        /// Frees everything allocated after the marker was taken. The
+        /// destructors of the objects are not called.
+        void Rewind(Marker marker);
+
         template <class T, class... Args>
         T* new_object(Args&& ...args)
         {
@@ -52,11 +90,44 @@ namespace rob
             if (object) object->~T();
         }
 
+    private:
+        bool Commit(const char *end, size_t_32 requested);
+        void Release();
+
     private:
         char *m_start;
         char *m_myMemory;
         char *m_head;
         const char *m_end;
+        /// End of the committed memory, or m_end when the memory is not
+        /// reserved.
+        const char *m_committed;
+        size_t_32 m_commitGranularity;
+        bool m_reserved;
+        bool m_prefault;
+    #if defined(ROB_MEMORY_TRACKING)
+        AllocatorStats m_stats;
+    #endif
+    };
+
+    /// Rewinds the allocator to where it was at the start of the scope.
+    class LinearAllocatorScope
+    {
+    public:
+        explicit LinearAllocatorScope(LinearAllocator &alloc)
+            : m_alloc(alloc)
+            , m_marker(alloc.GetMarker())
+        { }
+
+        LinearAllocatorScope(const LinearAllocatorScope&) = delete;
+        LinearAllocatorScope& operator = (const LinearAllocatorScope&) = delete;
+
+        ~LinearAllocatorScope()
+        { m_alloc.Rewind(m_marker); }
+
+    private:
+        LinearAllocator &m_alloc;
+        LinearAllocator::Marker m_marker;
     };
 
 } // rob
@@ -0,0 +1,136 @@
+
+#include "MemoryTracker.h"
+
+#include "../filesystem/FileSystem.h"
+#include "../String.h"
+#include "../Log.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace rob
+{
+
+    const char* GetMemoryTagName(MemoryTag tag)
+    {
+        switch (tag)
+        {
+        case MemoryTag::Untagged:   return "Untagged";
+        case MemoryTag::Game:       return "Game";
+        case MemoryTag::Graphics:   return "Graphics";
+        case MemoryTag::Audio:      return "Audio";
+        case MemoryTag::Renderer:   return "Renderer";
+        case MemoryTag::Resources:  return "Resources";
+        case MemoryTag::State:      return "State";
+        case MemoryTag::Frame:      return "Frame";
+        default: break;
+        }
+        return "?";
+    }
+
+#if defined(ROB_MEMORY_TRACKING)
+
+    static AllocatorStats *g_allocators = nullptr;
+    static std::atomic_flag g_allocatorsLock = ATOMIC_FLAG_INIT;
+
+    static void LockAllocators()
+    {
+        while (g_allocatorsLock.test_and_set(std::memory_order_acquire))
+        { }
+    }
+
+    static void UnlockAllocators()
+    { g_allocatorsLock.clear(std::memory_order_release); }
+
+    AllocatorStats::AllocatorStats()
+        : m_name("unnamed")
+        , m_tag(MemoryTag::Untagged)
+        , m_capacity(0)
+        , m_currentBytes(0)
+        , m_peakBytes(0)
+        , m_allocations(0)
+        , m_failedAllocations(0)
+        , m_prev(nullptr)
+        , m_next(nullptr)
+    {
+        LockAllocators();
+        m_next = g_allocators;
+        if (m_next) m_next->m_prev = this;
+        g_allocators = this;
+        UnlockAllocators();
+    }
+
+    AllocatorStats::~AllocatorStats()
+    {
+        LockAllocators();
+        if (m_prev) m_prev->m_next = m_next;
+        else g_allocators = m_next;
+        if (m_next) m_next->m_prev = m_prev;
+        UnlockAllocators();
+    }
+
+    static void ReportLine(fs::File file, const char *line)
+    {
+        log::Info(line);
+        if (file)
+        {
+            fs::Write(file, line, StringLength(line));
+            fs::Write(file, "\n", 1);
+        }
+    }
+
+    void ReportAllocatorUsage(const char *filename)
+    {
+        fs::File file = filename ? fs::OpenToWrite(filename) : nullptr;
+        if (filename && !file)
+            log::Error("Could not open ", filename, " for writing the memory report");
+
+        char line[256];
+        ReportLine(file, "Allocator usage by subsystem (B, nested allocators count also in their parent):");
+        std::snprintf(line, sizeof(line), "  %-28s %10s %10s %10s %8s %6s",
+                      "", "current", "peak", "capacity", "allocs", "failed");
+        ReportLine(file, line);
+
+        LockAllocators();
+        for (int t = 0; t < int(MemoryTag::Count); t++)
+        {
+            const MemoryTag tag = MemoryTag(t);
+            size_t_32 current = 0, peak = 0, capacity = 0;
+            uint32_t allocations = 0, failed = 0, count = 0;
+            for (const AllocatorStats *s = g_allocators; s; s = s->m_next)
+            {
+                if (s->m_tag != tag) continue;
+                current += s->m_currentBytes;
+                peak += s->m_peakBytes;
+                capacity += s->m_capacity;
+                allocations += s->m_allocations;
+                failed += s->m_failedAllocations;
+                count++;
+            }
+            if (count == 0) continue;
+
+            std::snprintf(line, sizeof(line), "  %-28s %10u %10u %10u %8u %6u",
+                          GetMemoryTagName(tag), current, peak, capacity, allocations, failed);
+            ReportLine(file, line);
+            for (const AllocatorStats *s = g_allocators; s; s = s->m_next)
+            {
+                if (s->m_tag != tag) continue;
+                std::snprintf(line, sizeof(line), "    %-26s %10u %10u %10u %8u %6u",
+                              s->m_name, s->m_currentBytes, s->m_peakBytes, s->m_capacity,
+                              s->m_allocations, s->m_failedAllocations);
+                ReportLine(file, line);
+            }
+        }
+        UnlockAllocators();
+
+        if (file) fs::Close(file);
+    }
+
+#else
+
+    void ReportAllocatorUsage(const char *filename)
+    { }
+
+#endif // ROB_MEMORY_TRACKING
+
+} // rob
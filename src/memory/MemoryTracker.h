@@ -0,0 +1,99 @@
+
+#ifndef H_ROB_MEMORY_TRACKER_H
+#define H_ROB_MEMORY_TRACKER_H
+
+#include "../Types.h"
+
+#if defined(ROB_DEBUG)
+    #define ROB_MEMORY_TRACKING
+#endif
+
+#if defined(ROB_MEMORY_TRACKING)
+    #define ROB_MEMORY_TRACK(statement) statement
+#else
+    #define ROB_MEMORY_TRACK(statement)
+#endif
+
+namespace rob
+{
+
+    /// The subsystem owning an allocator.
+    enum class MemoryTag
+    {
+        Untagged,
+        Game,
+        Graphics,
+        Audio,
+        Renderer,
+        Resources,
+        State,
+        Frame,
+        Count
+    };
+
+    const char* GetMemoryTagName(MemoryTag tag);
+
+#if defined(ROB_MEMORY_TRACKING)
+
+    /// Allocation statistics of an allocator. The statistics register
+    /// themselves to a global list for ReportAllocatorUsage.
+    class AllocatorStats
+    {
+    public:
+        AllocatorStats();
+        AllocatorStats(const AllocatorStats&) = delete;
+        AllocatorStats& operator = (const AllocatorStats&) = delete;
+        ~AllocatorStats();
+
+        void SetName(const char *name, MemoryTag tag)
+        { m_name = name; m_tag = tag; }
+        const char* GetName() const
+        { return m_name; }
+
+        void SetCapacity(size_t_32 bytes)
+        { m_capacity = bytes; }
+        void AddCapacity(size_t_32 bytes)
+        { m_capacity += bytes; }
+
+        void OnAllocate(size_t_32 bytes)
+        {
+            m_currentBytes += bytes;
+            if (m_currentBytes > m_peakBytes) m_peakBytes = m_currentBytes;
+            m_allocations++;
+        }
+
+        void OnFree(size_t_32 bytes)
+        { m_currentBytes -= bytes; }
+
+        void OnFail()
+        { m_failedAllocations++; }
+
+        /// For the allocators that free many allocations at once.
+        void SetCurrent(size_t_32 bytes)
+        { m_currentBytes = bytes; }
+
+    private:
+        friend void ReportAllocatorUsage(const char *filename);
+
+        const char *m_name;
+        MemoryTag m_tag;
+        size_t_32 m_capacity;
+        size_t_32 m_currentBytes;
+        size_t_32 m_peakBytes;
+        uint32_t m_allocations;
+        uint32_t m_failedAllocations;
+
+        AllocatorStats *m_prev;
+        AllocatorStats *m_next;
+    };
+
+#endif // ROB_MEMORY_TRACKING
+
+    /// Logs the usage of the tracked allocators by subsystem and writes the
+    /// report to the file, if one is given. Does nothing, when the tracking
+    /// is compiled out.
+    void ReportAllocatorUsage(const char *filename = nullptr);
+
+} // rob
+
+#endif // H_ROB_MEMORY_TRACKER_H
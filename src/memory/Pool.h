@@ -27,6 +27,10 @@ namespace rob
         ~Pool()
         { ROB_ASSERT(m_allocations == 0); }
 
+        /// Names the pool in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        { m_objects.SetName(name, tag); }
+
         size_t_32 GetAllocationCount() const
         { return m_allocations; }
 
@@ -41,6 +45,9 @@ namespace rob
         T* Get(size_t_32 index)
         { return m_start + index; }
 
+        const T* Get(size_t_32 index) const
+        { return m_start + index; }
+
         void Return(T *object)
         {
             ROB_ASSERT(m_start <= object && object < m_end);
@@ -0,0 +1,200 @@
+
+#include "PoolBenchmark.h"
+#include "AtomicFreelist.h"
+#include "ConcurrentPool.h"
+#include "LinearAllocator.h"
+#include "Pool.h"
+
+#include "../time/MicroTicker.h"
+#include "../Log.h"
+
+#include <SDL2/SDL.h>
+
+#include <atomic>
+
+namespace rob
+{
+
+    static const size_t_32 MAX_THREADS = 16;
+    // Objects held at once by a thread, like a burst of spawned objects.
+    static const size_t_32 BURST_SIZE = 16;
+    static const size_t_32 BURSTS_PER_THREAD = 20000;
+    // Room for the bursts and the thread caches of every thread.
+    static const size_t_32 OBJECT_COUNT = MAX_THREADS * 128;
+
+    struct BenchmarkObject
+    {
+        float m_data[8];
+    };
+
+    enum class PoolKind
+    {
+        MutexPool,
+        AtomicFreelist,
+        ConcurrentPool
+    };
+
+    struct BenchmarkShared
+    {
+        PoolKind m_kind;
+
+        SDL_mutex *m_mutex;
+        Pool<BenchmarkObject> *m_pool;
+
+        AtomicFreelist *m_freelist;
+        BenchmarkObject *m_freelistObjects;
+
+        ConcurrentPool<BenchmarkObject> *m_concurrentPool;
+
+        std::atomic<uint32_t> m_ready;
+        std::atomic<bool> m_start;
+        std::atomic<uint32_t> m_failures;
+    };
+
+    static BenchmarkObject* ObtainObject(BenchmarkShared *shared, ConcurrentPool<BenchmarkObject>::ThreadCache &cache)
+    {
+        switch (shared->m_kind)
+        {
+        case PoolKind::MutexPool:
+            {
+                ::SDL_LockMutex(shared->m_mutex);
+                BenchmarkObject *object = shared->m_pool->Obtain();
+                ::SDL_UnlockMutex(shared->m_mutex);
+                return object;
+            }
+        case PoolKind::AtomicFreelist:
+            {
+                const uint32_t index = shared->m_freelist->Obtain();
+                return (index != AtomicFreelist::NONE) ? shared->m_freelistObjects + index : nullptr;
+            }
+        case PoolKind::ConcurrentPool:
+            return shared->m_concurrentPool->Obtain(cache);
+        }
+        return nullptr;
+    }
+
+    static void ReturnObject(BenchmarkShared *shared, ConcurrentPool<BenchmarkObject>::ThreadCache &cache, BenchmarkObject *object)
+    {
+        switch (shared->m_kind)
+        {
+        case PoolKind::MutexPool:
+            ::SDL_LockMutex(shared->m_mutex);
+            shared->m_pool->Return(object);
+            ::SDL_UnlockMutex(shared->m_mutex);
+            break;
+        case PoolKind::AtomicFreelist:
+            shared->m_freelist->Return(static_cast<uint32_t>(object - shared->m_freelistObjects));
+            break;
+        case PoolKind::ConcurrentPool:
+            shared->m_concurrentPool->Return(cache, object);
+            break;
+        }
+    }
+
+    static int BenchmarkThread(void *data)
+    {
+        BenchmarkShared *shared = static_cast<BenchmarkShared*>(data);
+        ConcurrentPool<BenchmarkObject>::ThreadCache cache;
+        BenchmarkObject *objects[BURST_SIZE];
+
+        shared->m_ready.fetch_add(1, std::memory_order_release);
+        while (!shared->m_start.load(std::memory_order_acquire))
+            ::SDL_Delay(0);
+
+        for (size_t_32 burst = 0; burst < BURSTS_PER_THREAD; burst++)
+        {
+            for (size_t_32 i = 0; i < BURST_SIZE; i++)
+            {
+                objects[i] = ObtainObject(shared, cache);
+                if (objects[i] == nullptr)
+                {
+                    shared->m_failures.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                objects[i]->m_data[0] = float(i);
+            }
+            for (size_t_32 i = 0; i < BURST_SIZE; i++)
+            {
+                if (objects[i] != nullptr)
+                    ReturnObject(shared, cache, objects[i]);
+            }
+        }
+
+        if (shared->m_kind == PoolKind::ConcurrentPool)
+            shared->m_concurrentPool->Flush(cache);
+        return 0;
+    }
+
+    /// Returns the nanoseconds per obtain and return pair.
+    static double MeasureContention(BenchmarkShared &shared, size_t_32 threadCount)
+    {
+        shared.m_ready.store(0, std::memory_order_relaxed);
+        shared.m_start.store(false, std::memory_order_relaxed);
+
+        SDL_Thread *threads[MAX_THREADS];
+        for (size_t_32 i = 0; i < threadCount; i++)
+            threads[i] = ::SDL_CreateThread(&BenchmarkThread, "PoolBenchmark", &shared);
+
+        while (shared.m_ready.load(std::memory_order_acquire) < threadCount)
+            ::SDL_Delay(0);
+
+        MicroTicker ticker;
+        ticker.Init();
+        const Time_t start = ticker.GetTicks();
+        shared.m_start.store(true, std::memory_order_release);
+        for (size_t_32 i = 0; i < threadCount; i++)
+            ::SDL_WaitThread(threads[i], nullptr);
+        const Time_t elapsed = ticker.GetTicks() - start;
+
+        const double pairs = double(threadCount) * BURSTS_PER_THREAD * BURST_SIZE;
+        return double(elapsed) * 1000.0 / pairs;
+    }
+
+    void RunPoolBenchmark()
+    {
+        LinearAllocator alloc(512 * 1024);
+        alloc.SetName("Pool benchmark", MemoryTag::Untagged);
+
+        BenchmarkShared shared;
+        shared.m_mutex = ::SDL_CreateMutex();
+        shared.m_failures.store(0, std::memory_order_relaxed);
+
+        Pool<BenchmarkObject> pool;
+        const size_t_32 poolSize = GetArraySize<BenchmarkObject>(OBJECT_COUNT);
+        pool.SetMemory(alloc.AllocateArray<BenchmarkObject>(OBJECT_COUNT), poolSize);
+        shared.m_pool = &pool;
+
+        AtomicFreelist freelist;
+        std::atomic<uint32_t> *links = alloc.AllocateArray<std::atomic<uint32_t>>(OBJECT_COUNT);
+        for (size_t_32 i = 0; i < OBJECT_COUNT; i++)
+            new (links + i) std::atomic<uint32_t>(AtomicFreelist::NONE);
+        freelist.Init(links);
+        freelist.AddElements(0, OBJECT_COUNT);
+        shared.m_freelist = &freelist;
+        shared.m_freelistObjects = alloc.AllocateArray<BenchmarkObject>(OBJECT_COUNT);
+
+        ConcurrentPool<BenchmarkObject> concurrentPool;
+        concurrentPool.Init(alloc, OBJECT_COUNT);
+        shared.m_concurrentPool = &concurrentPool;
+
+        log::Info("Pool benchmark, ", ::SDL_GetCPUCount(), " CPUs, nanoseconds per obtain and return:");
+        const PoolKind kinds[] = { PoolKind::MutexPool, PoolKind::AtomicFreelist, PoolKind::ConcurrentPool };
+        const char * const names[] = { "mutex pool", "atomic freelist", "concurrent pool" };
+        const size_t_32 threadCounts[] = { 1, 2, 4, 8, 16 };
+        for (size_t_32 k = 0; k < 3; k++)
+        {
+            shared.m_kind = kinds[k];
+            for (size_t_32 threads : threadCounts)
+            {
+                const double ns = MeasureContention(shared, threads);
+                log::Info("  ", names[k], ", ", threads, " threads: ", ns);
+            }
+        }
+
+        if (shared.m_failures.load(std::memory_order_relaxed) > 0)
+            log::Warning("Pool benchmark: ", shared.m_failures.load(std::memory_order_relaxed), " failed obtains");
+
+        ::SDL_DestroyMutex(shared.m_mutex);
+    }
+
+} // rob
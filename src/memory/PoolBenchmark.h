@@ -0,0 +1,15 @@
+
+#ifndef H_ROB_POOL_BENCHMARK_H
+#define H_ROB_POOL_BENCHMARK_H
+
+namespace rob
+{
+
+    /// Measures the contention of a mutex guarded Pool, the AtomicFreelist
+    /// and the ConcurrentPool with 1 to 16 threads and logs the results.
+    /// Run with the --pool-benchmark command line option.
+    void RunPoolBenchmark();
+
+} // rob
+
+#endif // H_ROB_POOL_BENCHMARK_H
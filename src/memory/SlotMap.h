@@ -0,0 +1,274 @@
+
+#ifndef H_ROB_SLOT_MAP_H
+#define H_ROB_SLOT_MAP_H
+
+#include "LinearAllocator.h"
+#include "MemoryTracker.h"
+#include "PtrAlign.h"
+#include "../Assert.h"
+
+#include <new>
+#include <utility>
+
+namespace rob
+{
+
+    /// Objects stored densely in an array and referenced by handles. A
+    /// handle consists of the index of a slot and the generation of the
+    /// slot, so that a handle to a destroyed object is detected even after
+    /// the slot has been reused. The slot maps the handle to the position
+    /// of the object in the dense array.
+    ///
+    /// Destroying an object moves the last object to its place, so the
+    /// objects can be iterated linearly by index without holes. The objects
+    /// are relocated by move construction and destroyed after. Pointers to
+    /// the objects are valid until the next Destroy, or Create that grows
+    /// the storage; handles stay valid until the object is destroyed.
+    template <class T>
+    class SlotMap
+    {
+    public:
+        static const uint32_t INDEX_BITS = 20;
+        static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+        static const uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+        static const uint32_t INVALID_HANDLE = ~0u;
+
+    public:
+        SlotMap()
+            : m_objects(nullptr)
+            , m_denseToSlot(nullptr)
+            , m_slots(nullptr)
+            , m_size(0)
+            , m_capacity(0)
+            , m_freeHead(NO_SLOT)
+            , m_growable(true)
+            , m_heapMemory(nullptr)
+        { }
+
+        SlotMap(const SlotMap&) = delete;
+        SlotMap& operator = (const SlotMap&) = delete;
+
+        ~SlotMap()
+        {
+            ROB_ASSERT(m_size == 0);
+            Clear();
+            delete[] m_heapMemory;
+        }
+
+        /// Names the slot map in the memory reports.
+        void SetName(const char *name, MemoryTag tag)
+        { ROB_MEMORY_TRACK(m_stats.SetName(name, tag)); }
+
+        /// Allocates the storage for \c capacity objects from \c alloc. If
+        /// \c growable, the storage is moved to the heap with double the
+        /// capacity, when it runs out.
+        void Init(LinearAllocator &alloc, size_t_32 capacity, bool growable = true)
+        {
+            ROB_ASSERT(m_capacity == 0);
+            ROB_ASSERT(capacity > 0 && capacity <= INDEX_MASK);
+            m_growable = growable;
+            char *memory = static_cast<char*>(alloc.Allocate(GetStorageSize(capacity), GetStorageAlign()));
+            SetStorage(memory, capacity);
+        }
+
+        size_t_32 Size() const
+        { return m_size; }
+        size_t_32 GetCapacity() const
+        { return m_capacity; }
+        bool IsFull() const
+        { return m_size == m_capacity && !m_growable; }
+
+        /// Constructs a new object at the end of the dense array.
+        uint32_t Create()
+        {
+            if (m_size == m_capacity && !Grow())
+            {
+                ROB_MEMORY_TRACK(m_stats.OnFail());
+                ROB_ASSERT(0 && "SlotMap is full");
+                return INVALID_HANDLE;
+            }
+
+            const uint32_t slotIndex = m_freeHead;
+            Slot &slot = m_slots[slotIndex];
+            m_freeHead = slot.m_index;
+            slot.m_index = m_size;
+            m_denseToSlot[m_size] = slotIndex;
+            new (m_objects + m_size) T();
+            m_size++;
+            ROB_MEMORY_TRACK(m_stats.OnAllocate(sizeof(T)));
+            return (slot.m_generation << INDEX_BITS) | slotIndex;
+        }
+
+        bool IsValid(uint32_t handle) const
+        {
+            const uint32_t slotIndex = handle & INDEX_MASK;
+            if (slotIndex >= m_capacity)
+                return false;
+            const Slot &slot = m_slots[slotIndex];
+            return slot.m_index < m_size
+                && m_denseToSlot[slot.m_index] == slotIndex
+                && slot.m_generation == (handle >> INDEX_BITS);
+        }
+
+        T* Get(uint32_t handle)
+        {
+            ROB_ASSERT(IsValid(handle));
+            return m_objects + m_slots[handle & INDEX_MASK].m_index;
+        }
+
+        const T* Get(uint32_t handle) const
+        {
+            ROB_ASSERT(IsValid(handle));
+            return m_objects + m_slots[handle & INDEX_MASK].m_index;
+        }
+
+        void Destroy(uint32_t handle)
+        {
+            ROB_ASSERT(IsValid(handle));
+            DestroyAt(m_slots[handle & INDEX_MASK].m_index);
+        }
+
+        /// Destroys the object at the index of the dense array. The last
+        /// object is moved to the index.
+        void DestroyAt(size_t_32 index)
+        {
+            ROB_ASSERT(index < m_size);
+            const uint32_t slotIndex = m_denseToSlot[index];
+            const uint32_t last = m_size - 1;
+            m_objects[index].~T();
+            if (index != last)
+            {
+                new (m_objects + index) T(std::move(m_objects[last]));
+                m_objects[last].~T();
+                const uint32_t movedSlot = m_denseToSlot[last];
+                m_denseToSlot[index] = movedSlot;
+                m_slots[movedSlot].m_index = index;
+            }
+            m_size = last;
+
+            Slot &slot = m_slots[slotIndex];
+            slot.m_generation = (slot.m_generation + 1) & GENERATION_MASK;
+            slot.m_index = m_freeHead;
+            m_freeHead = slotIndex;
+            ROB_MEMORY_TRACK(m_stats.OnFree(sizeof(T)));
+        }
+
+        void Clear()
+        {
+            while (m_size > 0)
+                DestroyAt(m_size - 1);
+        }
+
+        /// Returns the object at the index of the dense array.
+        T& operator [] (size_t_32 index)
+        {
+            ROB_ASSERT(index < m_size);
+            return m_objects[index];
+        }
+
+        const T& operator [] (size_t_32 index) const
+        {
+            ROB_ASSERT(index < m_size);
+            return m_objects[index];
+        }
+
+        /// Returns the handle of the object at the index of the dense array.
+        uint32_t GetHandle(size_t_32 index) const
+        {
+            ROB_ASSERT(index < m_size);
+            const uint32_t slotIndex = m_denseToSlot[index];
+            return (m_slots[slotIndex].m_generation << INDEX_BITS) | slotIndex;
+        }
+
+        // For range-based for loops.
+        T* begin() { return m_objects; }
+        T* end() { return m_objects + m_size; }
+        const T* begin() const { return m_objects; }
+        const T* end() const { return m_objects + m_size; }
+
+    private:
+        static const uint32_t NO_SLOT = ~0u;
+
+        struct Slot
+        {
+            /// Index to the dense array, or the next free slot.
+            uint32_t m_index;
+            uint32_t m_generation;
+        };
+
+        static size_t_32 GetStorageAlign()
+        { return (alignof(T) > alignof(Slot)) ? alignof(T) : alignof(Slot); }
+
+        static size_t_32 GetObjectsSize(size_t_32 capacity)
+        { return align(GetArraySize<T>(capacity), alignof(Slot)); }
+
+        static size_t_32 GetStorageSize(size_t_32 capacity)
+        { return GetObjectsSize(capacity) + capacity * (sizeof(uint32_t) + sizeof(Slot)); }
+
+        /// Lays out the arrays in the memory and adds the new slots to the
+        /// free list. The existing objects and slots must have been moved
+        /// to the memory already.
+        void SetStorage(char *memory, size_t_32 capacity)
+        {
+            m_objects = reinterpret_cast<T*>(memory);
+            m_denseToSlot = reinterpret_cast<uint32_t*>(memory + GetObjectsSize(capacity));
+            m_slots = reinterpret_cast<Slot*>(m_denseToSlot + capacity);
+
+            // Link in reverse, so that the lowest index is obtained first.
+            for (size_t_32 i = capacity; i > m_capacity; i--)
+            {
+                Slot &slot = m_slots[i - 1];
+                slot.m_generation = 0;
+                slot.m_index = m_freeHead;
+                m_freeHead = i - 1;
+            }
+            ROB_MEMORY_TRACK(m_stats.AddCapacity(GetStorageSize(capacity) - GetStorageSize(m_capacity)));
+            m_capacity = capacity;
+        }
+
+        bool Grow()
+        {
+            if (!m_growable || m_capacity == 0 || m_capacity * 2 > INDEX_MASK)
+                return false;
+
+            const size_t_32 capacity = m_capacity * 2;
+            char *heapMemory = new char[GetStorageSize(capacity) + GetStorageAlign()];
+            char *memory = ptr_align(heapMemory, GetStorageAlign());
+
+            T *objects = reinterpret_cast<T*>(memory);
+            for (size_t_32 i = 0; i < m_size; i++)
+            {
+                new (objects + i) T(std::move(m_objects[i]));
+                m_objects[i].~T();
+            }
+            uint32_t *denseToSlot = reinterpret_cast<uint32_t*>(memory + GetObjectsSize(capacity));
+            Slot *slots = reinterpret_cast<Slot*>(denseToSlot + capacity);
+            for (size_t_32 i = 0; i < m_capacity; i++)
+            {
+                denseToSlot[i] = m_denseToSlot[i];
+                slots[i] = m_slots[i];
+            }
+
+            delete[] m_heapMemory;
+            m_heapMemory = heapMemory;
+            SetStorage(memory, capacity);
+            return true;
+        }
+
+    private:
+        T *m_objects;
+        uint32_t *m_denseToSlot;
+        Slot *m_slots;
+        size_t_32 m_size;
+        size_t_32 m_capacity;
+        uint32_t m_freeHead;
+        bool m_growable;
+        char *m_heapMemory;
+    #if defined(ROB_MEMORY_TRACKING)
+        AllocatorStats m_stats;
+    #endif
+    };
+
+} // rob
+
+#endif // H_ROB_SLOT_MAP_H
@@ -0,0 +1,95 @@
+
+#include "VirtualMemory.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace rob
+{
+namespace vm
+{
+
+#if defined(_WIN32)
+
+    size_t_32 GetPageSize()
+    {
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+
+    size_t_32 GetLargePageSize()
+    { return static_cast<size_t_32>(::GetLargePageMinimum()); }
+
+    void* Reserve(size_t_32 size)
+    { return ::VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS); }
+
+    bool Commit(void *address, size_t_32 size)
+    { return ::VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr; }
+
+    void* AllocateLarge(size_t_32 size)
+    {
+        // Fails without the "Lock pages in memory" privilege.
+        if (GetLargePageSize() == 0)
+            return nullptr;
+        return ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+
+    void Release(void *address, size_t_32 size)
+    { ::VirtualFree(address, 0, MEM_RELEASE); }
+
+#else
+
+    size_t_32 GetPageSize()
+    { return static_cast<size_t_32>(::sysconf(_SC_PAGESIZE)); }
+
+    size_t_32 GetLargePageSize()
+    {
+    #if defined(MAP_HUGETLB)
+        return 2 * 1024 * 1024;
+    #else
+        return 0;
+    #endif
+    }
+
+    void* Reserve(size_t_32 size)
+    {
+        void *address = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return (address != MAP_FAILED) ? address : nullptr;
+    }
+
+    bool Commit(void *address, size_t_32 size)
+    { return ::mprotect(address, size, PROT_READ | PROT_WRITE) == 0; }
+
+    void* AllocateLarge(size_t_32 size)
+    {
+    #if defined(MAP_HUGETLB)
+        // Fails, if the system has not reserved enough huge pages.
+        void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return (address != MAP_FAILED) ? address : nullptr;
+    #else
+        return nullptr;
+    #endif
+    }
+
+    void Release(void *address, size_t_32 size)
+    { ::munmap(address, size); }
+
+#endif // _WIN32
+
+    void Prefault(void *address, size_t_32 size)
+    {
+        const size_t_32 pageSize = GetPageSize();
+        volatile char *page = static_cast<volatile char*>(address);
+        for (size_t_32 offset = 0; offset < size; offset += pageSize)
+            page[offset] = 0;
+    }
+
+} // vm
+} // rob
@@ -0,0 +1,34 @@
+
+#ifndef H_ROB_VIRTUAL_MEMORY_H
+#define H_ROB_VIRTUAL_MEMORY_H
+
+#include "../Types.h"
+
+namespace rob
+{
+namespace vm
+{
+
+    size_t_32 GetPageSize();
+    /// Returns 0, if large pages are not supported.
+    size_t_32 GetLargePageSize();
+
+    /// Reserves address space without backing memory. Returns nullptr on
+    /// failure.
+    void* Reserve(size_t_32 size);
+    /// Backs the pages of a reserved range with memory.
+    bool Commit(void *address, size_t_32 size);
+    /// Reserves and commits the memory with large pages. Returns nullptr, if
+    /// large pages are not available.
+    void* AllocateLarge(size_t_32 size);
+    /// Frees a range returned by Reserve or AllocateLarge.
+    void Release(void *address, size_t_32 size);
+
+    /// Touches every page of the committed range, so that the first use of
+    /// the pages does not fault.
+    void Prefault(void *address, size_t_32 size);
+
+} // vm
+} // rob
+
+#endif // H_ROB_VIRTUAL_MEMORY_H
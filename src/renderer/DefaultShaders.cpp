@@ -50,17 +50,28 @@ namespace rob
 
 //            float alpha = texture2D(u_texture0, v_uv).r;
 
-            float buffer = 0.4975;
-            float gamma = 0.014;
-//            float buffer = 0.5;
-//            float gamma = 0.015;
+            // The glyph edge is at 0.5 in the distance field. The smoothing
+            // width follows the screen space derivative of the distance, so
+            // the edges stay sharp at any font scale.
+            float buffer = 0.5;
             float dist = texture2D(u_texture0, v_uv).r;
+            float gamma = 0.7 * fwidth(dist);
             float alpha = smoothstep(buffer - gamma, buffer + gamma, dist);
 
             gl_FragColor = vec4(color.rgb, alpha * color.a);
         }
     );
 
+    extern const char * const g_textureFragmentShader = GLSL(
+        uniform sampler2D u_texture0;
+        varying vec2 v_uv;
+        varying vec4 v_color;
+        void main()
+        {
+            gl_FragColor = texture2D(u_texture0, v_uv) * v_color;
+        }
+    );
+
 } // rob
 
 #undef GLSL
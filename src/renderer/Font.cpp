@@ -11,14 +11,18 @@ namespace rob
         , m_height(0)
         , m_horiSpacing(0)
         , m_lineSpacing(0)
+        , m_textureWidth(0)
+        , m_textureHeight(0)
+        , m_glyphDirectory(nullptr)
+        , m_glyphDirectorySize(0)
+        , m_glyphBlocks(nullptr)
+        , m_fallbackGlyph(nullptr)
+        , m_glyphMapping(nullptr)
         , m_glyphCount(0)
         , m_textureCount(0)
     {
-        for (size_t_32 i = 0; i < MAX_GLYPHS; i++)
-        {
-            m_glyphMapping[i] = 0;
-            m_glyph[i].m_textureIdx = -1;
-        }
+        for (size_t_32 i = 0; i < MAX_TEXTURE_PAGES; i++)
+            m_textures[i] = InvalidHandle;
     }
 
     bool Font::IsReady() const
@@ -48,20 +52,39 @@ namespace rob
     uint16_t Font::GetLineSpacing() const
     { return m_lineSpacing; }
 
-    void Font::AddGlyph(uint32_t character, const Glyph &glyph)
+    void Font::SetGlyphs(const uint16_t *directory, size_t_32 directorySize,
+                         const Glyph *blocks, const uint32_t *characters, size_t_32 count)
     {
-        const size_t_32 index = m_glyphCount++;
-        ROB_ASSERT(index < MAX_GLYPHS);
-        m_glyphMapping[index] = character;
-        m_glyph[character] = glyph;
+        ROB_ASSERT(directorySize <= MAX_GLYPH_BLOCKS);
+        m_glyphDirectory = directory;
+        m_glyphDirectorySize = directorySize;
+        m_glyphBlocks = blocks;
+        m_glyphMapping = characters;
+        m_glyphCount = count;
+
+        static const Glyph emptyGlyph = { };
+        m_fallbackGlyph = FindGlyph(uint32_t('?'));
+        if (!m_fallbackGlyph)
+            m_fallbackGlyph = &emptyGlyph;
+    }
+
+    const Glyph* Font::FindGlyph(uint32_t character) const
+    {
+        const uint32_t block = character >> GLYPH_BLOCK_BITS;
+        if (block >= m_glyphDirectorySize)
+            return nullptr;
+        const uint16_t blockIndex = m_glyphDirectory[block];
+        if (blockIndex == NO_GLYPH_BLOCK)
+            return nullptr;
+        const Glyph &glyph = m_glyphBlocks[(uint32_t(blockIndex) << GLYPH_BLOCK_BITS)
+                                           | (character & (GLYPH_BLOCK_SIZE - 1))];
+        return (glyph.m_textureIdx != NO_GLYPH) ? &glyph : nullptr;
     }
 
     const Glyph& Font::GetGlyph(uint32_t character) const
     {
-        ROB_ASSERT(character < MAX_GLYPHS);
-        if (m_glyph[character].m_textureIdx == uint16_t(-1))
-            return m_glyph[uint32_t('?')];
-        return m_glyph[character];
+        const Glyph *glyph = FindGlyph(character);
+        return glyph ? *glyph : *m_fallbackGlyph;
     }
 
     const Glyph& Font::GetGlyphByIndex(size_t_32 index) const
@@ -74,6 +97,31 @@ namespace rob
     size_t_32 Font::GetGlyphCount() const
     { return m_glyphCount; }
 
+    void Font::SetTextureSize(uint16_t width, uint16_t height)
+    {
+        m_textureWidth = width;
+        m_textureHeight = height;
+    }
+
+    uint16_t Font::GetTextureWidth() const
+    { return m_textureWidth; }
+
+    uint16_t Font::GetTextureHeight() const
+    { return m_textureHeight; }
+
+    void Font::SetTexturePage(size_t_32 page, ResourceID id)
+    {
+        ROB_ASSERT(page < MAX_TEXTURE_PAGES);
+        m_texturePages[page] = id;
+        m_textureCount = (page + 1 > m_textureCount) ? page + 1 : m_textureCount;
+    }
+
+    ResourceID Font::GetTexturePage(size_t_32 page) const
+    {
+        ROB_ASSERT(page < m_textureCount);
+        return m_texturePages[page];
+    }
+
     void Font::AddTexture(size_t_32 page, TextureHandle texture)
     {
         ROB_ASSERT(page < MAX_TEXTURE_PAGES);
@@ -81,6 +129,12 @@ namespace rob
         m_textureCount = (page + 1 > m_textureCount) ? page + 1 : m_textureCount;
     }
 
+    bool Font::HasTexture(size_t_32 page) const
+    {
+        ROB_ASSERT(page < MAX_TEXTURE_PAGES);
+        return m_textures[page] != InvalidHandle;
+    }
+
     TextureHandle Font::GetTexture(size_t_32 page) const
     {
         ROB_ASSERT(page < MAX_TEXTURE_PAGES);
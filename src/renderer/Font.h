@@ -3,6 +3,7 @@
 #define H_ROB_FONT_H
 
 #include "../graphics/GraphicsTypes.h"
+#include "../resource/ResourceID.h"
 #include "../Types.h"
 
 namespace rob
@@ -24,6 +25,19 @@ namespace rob
 
     class Font
     {
+    public:
+        static const size_t_32 MAX_TEXTURE_PAGES = 8;
+
+        /// The glyphs are looked up from blocks of 256 consecutive code
+        /// points. The block directory maps the upper bits of a code point to
+        /// a block, so only the used ranges of the code space take memory.
+        static const uint32_t GLYPH_BLOCK_BITS = 8;
+        static const uint32_t GLYPH_BLOCK_SIZE = 1 << GLYPH_BLOCK_BITS;
+        static const uint32_t MAX_CODE_POINT = 0x10FFFF;
+        static const uint32_t MAX_GLYPH_BLOCKS = (MAX_CODE_POINT >> GLYPH_BLOCK_BITS) + 1;
+        static const uint16_t NO_GLYPH_BLOCK = 0xFFFF;
+        static const uint16_t NO_GLYPH = 0xFFFF;
+
     public:
         Font();
 
@@ -41,30 +55,52 @@ namespace rob
         void SetLineSpacing(uint16_t spacing);
         uint16_t GetLineSpacing() const;
 
-        void AddGlyph(uint32_t index, const Glyph &glyph);
+        /// Sets the block directory, the glyph blocks and the characters of
+        /// the font. The font does not copy the tables, they must outlive the
+        /// font. Glyphs with texture index of NO_GLYPH are missing.
+        void SetGlyphs(const uint16_t *directory, size_t_32 directorySize,
+                       const Glyph *blocks, const uint32_t *characters, size_t_32 count);
+        /// Returns the glyph of '?' for missing characters.
         const Glyph& GetGlyph(uint32_t character) const;
 
         const Glyph& GetGlyphByIndex(size_t_32 index) const;
         size_t_32 GetGlyphCount() const;
 
+        /// Sets the size used to normalize the glyph coordinates to texture
+        /// coordinates. The page textures can have a lower resolution.
+        void SetTextureSize(uint16_t width, uint16_t height);
+        uint16_t GetTextureWidth() const;
+        uint16_t GetTextureHeight() const;
+
+        /// The page textures are loaded when a glyph on the page is first
+        /// drawn, so the font knows only the resource ids of the pages.
+        void SetTexturePage(size_t_32 page, ResourceID id);
+        ResourceID GetTexturePage(size_t_32 page) const;
+
         void AddTexture(size_t_32 page, TextureHandle texture);
+        bool HasTexture(size_t_32 page) const;
         TextureHandle GetTexture(size_t_32 page) const;
         size_t_32 GetTextureCount() const;
 
+    private:
+        const Glyph* FindGlyph(uint32_t character) const;
+
     private:
         uint16_t m_base;
         uint16_t m_height;
         uint16_t m_horiSpacing;
         uint16_t m_lineSpacing;
-
-        // TODO: Enable dynamic glyph count (no hard coded limit).
-        // The alocations should be done by FontManager.
-        static const size_t_32 MAX_GLYPHS = 256;
-        Glyph m_glyph[MAX_GLYPHS];
-        uint32_t m_glyphMapping[MAX_GLYPHS];
+        uint16_t m_textureWidth;
+        uint16_t m_textureHeight;
+
+        const uint16_t *m_glyphDirectory;
+        size_t_32 m_glyphDirectorySize;
+        const Glyph *m_glyphBlocks;
+        const Glyph *m_fallbackGlyph;
+        const uint32_t *m_glyphMapping;
         size_t_32 m_glyphCount;
 
-        static const size_t_32 MAX_TEXTURE_PAGES = 8;
+        ResourceID m_texturePages[MAX_TEXTURE_PAGES];
         TextureHandle m_textures[MAX_TEXTURE_PAGES];
         size_t_32 m_textureCount;
 
@@ -7,14 +7,19 @@
 #include "../graphics/Texture.h"
 
 #include "../resource/MasterCache.h"
+#include "../filesystem/FileSystem.h"
+#include "../time/MicroTicker.h"
 
 #include "../math/Math.h"
 
+#include "../Assert.h"
 #include "../Log.h"
 #include "../String.h"
 
 #include <GL/glew.h>
 
+#include <cstring>
+
 namespace rob
 {
 
@@ -22,6 +27,7 @@ namespace rob
     extern const char * const g_colorFragmentShader;
     extern const char * const g_fontVertexShader;
     extern const char * const g_fontFragmentShader;
+    extern const char * const g_textureFragmentShader;
 
     struct ColorVertex
     {
@@ -36,7 +42,101 @@ namespace rob
     };
 
 
+    static const char * const PROGRAM_BINARY_FILE = "shader_cache.bin";
+    static const uint32_t PROGRAM_BINARY_MAGIC = 0x42485352; // "RSHB"
+
+    struct ProgramBinaryHeader
+    {
+        uint32_t magic;
+        uint32_t count;
+    };
+
+    struct ProgramBinaryEntry
+    {
+        uint64_t hash;
+        uint32_t format;
+        uint32_t size;
+    };
+
+    static uint64_t HashShaderSource(const char *vert, const char *frag)
+    {
+        const uint64_t prime = 1099511628211ULL;
+        uint64_t hash = 14695981039346656037ULL;
+        for (const char *s = vert; *s; s++)
+            hash = (hash ^ uint8_t(*s)) * prime;
+        // Separate the sources, so that moving text from one to another changes the hash.
+        hash = (hash ^ 0xff) * prime;
+        for (const char *s = frag; *s; s++)
+            hash = (hash ^ uint8_t(*s)) * prime;
+        return hash;
+    }
+
     ShaderProgramHandle Renderer::CompileShaderProgram(const char * const vert, const char * const frag)
+    {
+        const uint64_t hash = HashShaderSource(vert, frag);
+        for (size_t_32 i = 0; i < m_programCacheCount; i++)
+        {
+            CachedProgram &cached = m_programCache[i];
+            if (cached.m_hash == hash)
+            {
+                cached.m_references++;
+                return cached.m_program;
+            }
+        }
+
+        MicroTicker ticker;
+        ticker.Init();
+        const Time_t start = ticker.GetTicks();
+
+        ShaderProgramHandle p = LoadProgramBinary(hash);
+        const bool fromBinary = (p != InvalidHandle);
+        if (!fromBinary)
+            p = LinkShaderProgram(vert, frag);
+        if (p == InvalidHandle)
+            return InvalidHandle;
+
+        m_graphics->AddProgramUniform(p, m_globals.projection);
+        m_graphics->AddProgramUniform(p, m_globals.position);
+        m_graphics->AddProgramUniform(p, m_globals.time_ms);
+        m_graphics->AddProgramUniform(p, m_globals.texture0);
+
+        const Time_t time = ticker.GetTicks() - start;
+        log::Info("Renderer: Shader program ", (fromBinary ? "loaded from binary" : "compiled"),
+                  " in ", time, " us");
+
+        if (m_programCacheCount < MAX_CACHED_PROGRAMS)
+        {
+            CachedProgram &cached = m_programCache[m_programCacheCount++];
+            cached.m_hash = hash;
+            cached.m_program = p;
+            cached.m_references = 1;
+            cached.m_baseUniforms = m_graphics->GetShaderProgram(p)->GetUniformCount();
+        }
+        return p;
+    }
+
+    void Renderer::ReleaseShaderProgram(ShaderProgramHandle program)
+    {
+        if (program == InvalidHandle)
+            return;
+
+        for (size_t_32 i = 0; i < m_programCacheCount; i++)
+        {
+            CachedProgram &cached = m_programCache[i];
+            if (cached.m_program == program)
+            {
+                ROB_ASSERT(cached.m_references > 0);
+                // The program stays in the cache, but the uniforms added by
+                // the user are removed, as they are not global.
+                if (--cached.m_references == 0)
+                    m_graphics->GetShaderProgram(program)->RemoveUniforms(m_graphics, cached.m_baseUniforms);
+                return;
+            }
+        }
+        m_graphics->DestroyShaderProgram(program);
+    }
+
+    ShaderProgramHandle Renderer::LinkShaderProgram(const char * const vert, const char * const frag)
     {
         VertexShaderHandle vs = m_graphics->CreateVertexShader();
         VertexShader *vertShader = m_graphics->GetVertexShader(vs);
@@ -66,6 +166,8 @@ namespace rob
         ShaderProgramHandle p = m_graphics->CreateShaderProgram();
         ShaderProgram *program = m_graphics->GetShaderProgram(p);
         program->SetShaders(vertShader, fragShader);
+        if (m_graphics->HasProgramBinary())
+            program->SetBinaryRetrievable();
         if (!program->Link())
         {
             char buffer[512];
@@ -73,35 +175,137 @@ namespace rob
             log::Error(&buffer[0]);
             m_graphics->DestroyVertexShader(vs);
             m_graphics->DestroyFragmentShader(fs);
-            m_graphics->DestroyFragmentShader(p);
+            m_graphics->DestroyShaderProgram(p);
             return InvalidHandle;
         }
 
         m_graphics->DestroyVertexShader(vs);
         m_graphics->DestroyFragmentShader(fs);
-
-        m_graphics->AddProgramUniform(p, m_globals.projection);
-        m_graphics->AddProgramUniform(p, m_globals.position);
-        m_graphics->AddProgramUniform(p, m_globals.time_ms);
-        m_graphics->AddProgramUniform(p, m_globals.texture0);
         return p;
     }
 
+    ShaderProgramHandle Renderer::LoadProgramBinary(uint64_t hash)
+    {
+        if (!m_graphics->HasProgramBinary() || !m_programBinaries.IsOpen())
+            return InvalidHandle;
+
+        const uint8_t *data = m_programBinaries.GetData();
+        const size_t_32 size = m_programBinaries.GetSize();
+
+        ProgramBinaryHeader header;
+        if (size < sizeof(header))
+            return InvalidHandle;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != PROGRAM_BINARY_MAGIC)
+            return InvalidHandle;
+
+        size_t_32 pos = sizeof(header);
+        for (uint32_t i = 0; i < header.count; i++)
+        {
+            ProgramBinaryEntry entry;
+            if (size - pos < sizeof(entry))
+                break;
+            std::memcpy(&entry, data + pos, sizeof(entry));
+            pos += sizeof(entry);
+            if (size - pos < entry.size)
+                break;
+
+            if (entry.hash == hash)
+            {
+                ShaderProgramHandle p = m_graphics->CreateShaderProgram();
+                ShaderProgram *program = m_graphics->GetShaderProgram(p);
+                if (program->LoadBinary(entry.format, data + pos, entry.size))
+                    return p;
+                m_graphics->DestroyShaderProgram(p);
+                return InvalidHandle;
+            }
+            pos += entry.size;
+        }
+        return InvalidHandle;
+    }
+
+    void Renderer::SaveProgramBinaries()
+    {
+        if (!m_graphics->HasProgramBinary())
+            return;
+
+        m_programBinaries.Close();
+
+        ProgramBinaryHeader header;
+        header.magic = PROGRAM_BINARY_MAGIC;
+        header.count = 0;
+        size_t_32 maxSize = 0;
+        for (size_t_32 i = 0; i < m_programCacheCount; i++)
+        {
+            const size_t_32 size = m_graphics->GetShaderProgram(m_programCache[i].m_program)->GetBinarySize();
+            if (size == 0)
+                continue;
+            header.count++;
+            if (size > maxSize) maxSize = size;
+        }
+
+        // The binaries are copied through one scratch buffer.
+        LinearAllocatorScope scratchScope(m_vb_alloc);
+        char *buffer = m_vb_alloc.AllocateArray<char>(maxSize);
+        if (!buffer)
+        {
+            log::Error("Renderer: No memory for a program binary of ", maxSize, " B");
+            return;
+        }
+
+        fs::File file = fs::OpenToWrite(PROGRAM_BINARY_FILE);
+        if (!file)
+        {
+            log::Error("Renderer: Could not open ", PROGRAM_BINARY_FILE, " for writing");
+            return;
+        }
+        fs::Write(file, header);
+
+        for (size_t_32 i = 0; i < m_programCacheCount; i++)
+        {
+            const ShaderProgram *program = m_graphics->GetShaderProgram(m_programCache[i].m_program);
+            const size_t_32 size = program->GetBinarySize();
+            if (size == 0)
+                continue;
+
+            GLenum format = 0;
+            ProgramBinaryEntry entry;
+            entry.hash = m_programCache[i].m_hash;
+            entry.size = program->GetBinary(buffer, size, &format);
+            entry.format = format;
+            fs::Write(file, entry);
+            fs::Write(file, buffer, entry.size);
+        }
+        fs::Close(file);
+    }
+
     static const size_t_32 RENDERER_MEMORY = 4 * 1024;
     static const size_t_32 MAX_VERTEX_BUFFER_SIZE = 1 * 1024 * 1024;
+    static const size_t_32 MAX_SPRITES_PER_BATCH = 1024;
 
     Renderer::Renderer(Graphics *graphics, MasterCache *cache, LinearAllocator &alloc)
         : m_alloc(alloc.Allocate(RENDERER_MEMORY), RENDERER_MEMORY)
         , m_vb_alloc(alloc.Allocate(MAX_VERTEX_BUFFER_SIZE), MAX_VERTEX_BUFFER_SIZE)
         , m_graphics(graphics)
+        , m_cache(cache)
         , m_globals()
         , m_vertexBuffer(InvalidHandle)
         , m_colorProgram(InvalidHandle)
         , m_fontProgram(InvalidHandle)
+        , m_textureProgram(InvalidHandle)
+        , m_shader(InvalidHandle)
+        , m_programCacheCount(0)
+        , m_programBinaries()
+        , m_spriteVertices(nullptr)
+        , m_spriteCount(0)
+        , m_spriteTexture(InvalidHandle)
         , m_color(Color::White)
         , m_font()
         , m_fontScale(1.0f)
     {
+        m_alloc.SetName("Renderer", MemoryTag::Renderer);
+        m_vb_alloc.SetName("Renderer vertices", MemoryTag::Renderer);
+
         m_globals.projection    = m_graphics->CreateGlobalUniform("u_projection", UniformType::Mat4);
         m_globals.position      = m_graphics->CreateGlobalUniform("u_position", UniformType::Vec4);
         m_globals.time_ms      = m_graphics->CreateGlobalUniform("u_time_ms", UniformType::Int);
@@ -110,8 +314,13 @@ namespace rob
         m_graphics->SetUniform(m_globals.time_ms, 0);
         m_graphics->SetUniform(m_globals.texture0, 0);
 
+        m_programBinaries.Open(PROGRAM_BINARY_FILE);
+
         m_colorProgram = CompileShaderProgram(g_colorVertexShader, g_colorFragmentShader);
         m_fontProgram = CompileShaderProgram(g_fontVertexShader, g_fontFragmentShader);
+        m_textureProgram = CompileShaderProgram(g_fontVertexShader, g_textureFragmentShader);
+
+        m_spriteVertices = alloc.AllocateArray<FontVertex>(MAX_SPRITES_PER_BATCH * 6);
 
 //        m_font = cache->GetFont("lucida_24.fnt");
 //        m_font = cache->GetFont("dejavu_24.fnt");
@@ -127,10 +336,16 @@ namespace rob
     Renderer::~Renderer()
     {
         m_graphics->DestroyVertexBuffer(m_vertexBuffer);
-        if (m_colorProgram != InvalidHandle)
-            m_graphics->DestroyShaderProgram(m_colorProgram);
-        if (m_fontProgram != InvalidHandle)
-            m_graphics->DestroyShaderProgram(m_fontProgram);
+        ReleaseShaderProgram(m_colorProgram);
+        ReleaseShaderProgram(m_fontProgram);
+        ReleaseShaderProgram(m_textureProgram);
+
+        SaveProgramBinaries();
+        for (size_t_32 i = 0; i < m_programCacheCount; i++)
+        {
+            ROB_WARN(m_programCache[i].m_references > 0);
+            m_graphics->DestroyShaderProgram(m_programCache[i].m_program);
+        }
         m_graphics->DecRefUniform(m_globals.projection);
         m_graphics->DecRefUniform(m_globals.position);
         m_graphics->DecRefUniform(m_globals.time_ms);
@@ -148,6 +363,7 @@ namespace rob
 
     void Renderer::SetView(const View &view)
     {
+        FlushSprites();
         m_view = view;
         m_graphics->SetViewport(m_view.m_viewport.x,
                                 m_view.m_viewport.y,
@@ -178,7 +394,11 @@ namespace rob
 
 
     void Renderer::BindShader(ShaderProgramHandle shader)
-    { m_graphics->BindShaderProgram(shader); }
+    {
+        FlushSprites();
+        m_graphics->BindShaderProgram(shader);
+        m_shader = shader;
+    }
 
     void Renderer::BindColorShader()
     { BindShader(m_colorProgram); }
@@ -186,14 +406,19 @@ namespace rob
     void Renderer::BindFontShader()
     { BindShader(m_fontProgram); }
 
+    void Renderer::BindTextureShader()
+    { BindShader(m_textureProgram); }
+
     void Renderer::SetColor(const Color &color)
     { m_color = color; }
 
     void Renderer::DrawLine(float x0, float y0, float x1, float y1)
     {
+        FlushSprites();
         const float dx = x1 - x0;
         const float dy = y1 - y0;
         const size_t_32 vertexCount = 2;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
         vertices[0] = { 0.0f, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a };
         vertices[1] = { dx, dy, m_color.r, m_color.g, m_color.b, m_color.a };
@@ -206,15 +431,15 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawLineLoopArrays(0, vertexCount);
-
-        m_vb_alloc.Reset();
     }
 
     void Renderer::DrawRectangle(float x0, float y0, float x1, float y1)
     {
+        FlushSprites();
         const float w = x1 - x0;
         const float h = y1 - y0;
         const size_t_32 vertexCount = 4;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
         vertices[0] = { 0.0f, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a };
         vertices[1] = { w, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a };
@@ -229,15 +454,15 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawLineLoopArrays(0, vertexCount);
-
-        m_vb_alloc.Reset();
     }
 
     void Renderer::DrawFilledRectangle(float x0, float y0, float x1, float y1)
     {
+        FlushSprites();
         const float w = x1 - x0;
         const float h = y1 - y0;
         const size_t_32 vertexCount = 4;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
         vertices[0] = { 0.0f, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a };
         vertices[1] = { w, 0.0f, m_color.r, m_color.g, m_color.b, m_color.a };
@@ -252,8 +477,6 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawTriangleStripArrays(0, vertexCount);
-
-        m_vb_alloc.Reset();
     }
 
     static const size_t_32 CIRCLE_SEGMENTS = 48;
@@ -261,10 +484,12 @@ namespace rob
 
     void Renderer::DrawCirlce(float x, float y, float radius)
     {
+        FlushSprites();
         const size_t_32 segs = CIRCLE_SEGMENTS * (radius / SEG_RADIUS_SCALE);
         const size_t_32 segments = Min((segs + 3) & ~0x3, CIRCLE_SEGMENTS);
         const size_t_32 quarter = segments / 4;
         const size_t_32 vertexCount = segments;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
 
         float angle = 0.0f;
@@ -294,16 +519,16 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawLineLoopArrays(0, vertexCount);
-
-        m_vb_alloc.Reset();
     }
 
     void Renderer::DrawFilledCirlce(float x, float y, float radius)
     {
+        FlushSprites();
         const size_t_32 segs = CIRCLE_SEGMENTS * (radius / SEG_RADIUS_SCALE);
         const size_t_32 segments = Min((segs + 3) & ~0x3, CIRCLE_SEGMENTS);
         const size_t_32 quarter = segments / 4;
         const size_t_32 vertexCount = segments + 2;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
 
         float angle = 0.0f;
@@ -335,16 +560,16 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawTriangleFanArrays(0, vertexCount);
-
-        m_vb_alloc.Reset();
     }
 
     void Renderer::DrawFilledCirlce(float x, float y, float radius, const Color &center)
     {
+        FlushSprites();
         const size_t_32 segs = CIRCLE_SEGMENTS * (radius / SEG_RADIUS_SCALE);
         const size_t_32 segments = Min((segs + 3) & ~0x3, CIRCLE_SEGMENTS);
         const size_t_32 quarter = segments / 4;
         const size_t_32 vertexCount = segments + 2;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         ColorVertex* vertices = m_vb_alloc.AllocateArray<ColorVertex>(vertexCount);
 
         float angle = 0.0f;
@@ -376,10 +601,48 @@ namespace rob
         m_graphics->SetAttrib(0, 2, sizeof(ColorVertex), 0);
         m_graphics->SetAttrib(1, 4, sizeof(ColorVertex), sizeof(float) * 2);
         m_graphics->DrawTriangleFanArrays(0, vertexCount);
+    }
+
+
+    void Renderer::DrawSprite(const TextureRegion &region, float x, float y, float w, float h)
+    {
+        if (region.m_texture != m_spriteTexture || m_spriteCount == MAX_SPRITES_PER_BATCH)
+        {
+            FlushSprites();
+            m_spriteTexture = region.m_texture;
+        }
 
-        m_vb_alloc.Reset();
+        FontVertex *vertex = m_spriteVertices + m_spriteCount * 6;
+        AddFontVertex(vertex, x,        y,      region.m_u0, region.m_v0);
+        AddFontVertex(vertex, x + w,    y,      region.m_u1, region.m_v0);
+        AddFontVertex(vertex, x,        y + h,  region.m_u0, region.m_v1);
+        AddFontVertex(vertex, x,        y + h,  region.m_u0, region.m_v1);
+        AddFontVertex(vertex, x + w,    y,      region.m_u1, region.m_v0);
+        AddFontVertex(vertex, x + w,    y + h,  region.m_u1, region.m_v1);
+        m_spriteCount++;
     }
 
+    void Renderer::FlushSprites()
+    {
+        if (m_spriteCount == 0)
+            return;
+
+        const size_t_32 vertexCount = m_spriteCount * 6;
+        m_spriteCount = 0;
+
+        m_graphics->SetUniform(m_globals.position, vec4f(0.0f, 0.0f, 0.0f, 1.0f));
+        m_graphics->BindVertexBuffer(m_vertexBuffer);
+        VertexBuffer *buffer = m_graphics->GetVertexBuffer(m_vertexBuffer);
+        buffer->Write(0, vertexCount * sizeof(FontVertex), m_spriteVertices);
+        m_graphics->SetAttrib(0, 4, sizeof(FontVertex), 0);
+        m_graphics->SetAttrib(1, 4, sizeof(FontVertex), sizeof(float) * 4);
+        m_graphics->BindTexture(0, m_spriteTexture);
+        // The sprites are drawn with the texture shader regardless of the
+        // shader bound by the user, which is restored after.
+        m_graphics->BindShaderProgram(m_textureProgram);
+        m_graphics->DrawTriangleArrays(0, vertexCount);
+        m_graphics->BindShaderProgram(m_shader);
+    }
 
     void Renderer::AddFontVertex(FontVertex *&vertex, const float x, const float y, const float u, const float v)
     {
@@ -416,8 +679,18 @@ namespace rob
         cursorX += float(glyph.m_advance) * m_fontScale;
     }
 
+    TextureHandle Renderer::GetFontTexture(size_t_32 page)
+    {
+        // The page textures are loaded when first used, so the fonts with
+        // large character sets load only the pages of the scripts in use.
+        if (!m_font.HasTexture(page))
+            m_font.AddTexture(page, m_cache->GetTextureAsync(m_font.GetTexturePage(page)));
+        return m_font.GetTexture(page);
+    }
+
     void Renderer::DrawText(float x, float y, const char *text)
     {
+        FlushSprites();
         if (!m_font.IsReady()) return;
 
         m_graphics->SetUniform(m_globals.position, vec4f(x, y, 0.0f, 1.0f));
@@ -428,6 +701,7 @@ namespace rob
 
         const size_t_32 textLen = StringLength(text);
         const size_t_32 maxVertexCount = textLen * 6;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         FontVertex * const verticesStart = m_vb_alloc.AllocateArray<FontVertex>(maxVertexCount);
         float cursorX = x;
         float cursorY = y;
@@ -444,11 +718,10 @@ namespace rob
 
                 const Glyph &glyph = m_font.GetGlyph(c);
                 uint16_t texturePage = glyph.m_textureIdx;
-                const TextureHandle textureHandle = m_font.GetTexture(texturePage);
-                const Texture *texture = m_graphics->GetTexture(textureHandle);
+                const TextureHandle textureHandle = GetFontTexture(texturePage);
 
-                const size_t_32 textureW = texture->GetWidth();
-                const size_t_32 textureH = texture->GetHeight();
+                const size_t_32 textureW = m_font.GetTextureWidth();
+                const size_t_32 textureH = m_font.GetTextureHeight();
 
                 AddFontQuad(vertex, c, glyph, cursorX, cursorY, textureW, textureH);
 
@@ -472,7 +745,6 @@ namespace rob
                 m_graphics->DrawTriangleArrays(0, vertexCount);
             } while (oneMore || text != end);
         }
-        m_vb_alloc.Reset();
     }
 
     float Renderer::GetTextWidth(const char *text) const
@@ -504,6 +776,7 @@ namespace rob
 
     void Renderer::DrawTextAscii(float x, float y, const char *text)
     {
+        FlushSprites();
         if (!m_font.IsReady()) return;
 
         m_graphics->SetUniform(m_globals.position, vec4f(x, y, 0.0f, 1.0f));
@@ -514,6 +787,7 @@ namespace rob
 
         const size_t_32 textLen = StringLength(text);
         const size_t_32 maxVertexCount = textLen * 6;
+        LinearAllocatorScope vbScope(m_vb_alloc);
         FontVertex * const verticesStart = m_vb_alloc.AllocateArray<FontVertex>(maxVertexCount);
         float cursorX = x;
         float cursorY = y;
@@ -527,11 +801,10 @@ namespace rob
             const Glyph &glyph = m_font.GetGlyph(c);
 
             uint16_t texturePage = glyph.m_textureIdx;
-            const TextureHandle textureHandle = m_font.GetTexture(texturePage);
-            const Texture *texture = m_graphics->GetTexture(textureHandle);
+            const TextureHandle textureHandle = GetFontTexture(texturePage);
 
-            const size_t_32 textureW = texture->GetWidth();
-            const size_t_32 textureH = texture->GetHeight();
+            const size_t_32 textureW = m_font.GetTextureWidth();
+            const size_t_32 textureH = m_font.GetTextureHeight();
 
             AddFontQuad(vertex, c, glyph, cursorX, cursorY, textureW, textureH);
             while (text != end)
@@ -549,7 +822,6 @@ namespace rob
             m_graphics->BindTexture(0, textureHandle);
             m_graphics->DrawTriangleArrays(0, vertexCount);
         }
-        m_vb_alloc.Reset();
     }
 
     float Renderer::GetTextWidthAscii(const char *text) const
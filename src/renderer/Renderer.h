@@ -4,6 +4,7 @@
 
 #include "../graphics/GraphicsTypes.h"
 #include "../resource/ResourceID.h"
+#include "../resource/TextureRegion.h"
 #include "Color.h"
 #include "Font.h"
 
@@ -11,6 +12,7 @@
 #include "../math/Matrix4.h"
 
 #include "../memory/LinearAllocator.h"
+#include "../filesystem/MappedFile.h"
 
 namespace rob
 {
@@ -54,7 +56,12 @@ namespace rob
         Renderer& operator = (const Renderer&) = delete;
         ~Renderer();
 
+        /// Compiles and links a shader program, or returns the cached program
+        /// compiled from the same sources. The program must be released with
+        /// ReleaseShaderProgram. The cached programs are kept until the renderer
+        /// is destroyed and their binaries are saved to disk, if supported.
         ShaderProgramHandle CompileShaderProgram(const char * const vert, const char * const frag);
+        void ReleaseShaderProgram(ShaderProgramHandle program);
 
         Graphics* GetGraphics();
         const GlobalUniforms& GetGlobals() const;
@@ -68,6 +75,7 @@ namespace rob
         void BindShader(ShaderProgramHandle shader);
         void BindColorShader();
         void BindFontShader();
+        void BindTextureShader();
 
         void SetColor(const Color &color);
 
@@ -78,6 +86,14 @@ namespace rob
         void DrawFilledCirlce(float x, float y, float radius);
         void DrawFilledCirlce(float x, float y, float radius, const Color &center);
 
+        /// Draws a textured rectangle with the texture shader. Consecutive sprites
+        /// from the same texture (e.g. from one atlas page) are batched to a single
+        /// draw call. The batch is drawn before any other draw call, when the
+        /// texture changes, when it is full, when the shader or view changes, or
+        /// when FlushSprites is called. Call FlushSprites at the end of a frame.
+        void DrawSprite(const TextureRegion &region, float x, float y, float w, float h);
+        void FlushSprites();
+
         void DrawText(float x, float y, const char *text);
         float GetTextWidth(const char *text) const;
         float GetTextWidth(const char *text, size_t_32 charCount) const;
@@ -93,15 +109,21 @@ namespace rob
         float GetFontLineSpacing() const;
 
     private:
+        ShaderProgramHandle LinkShaderProgram(const char * const vert, const char * const frag);
+        ShaderProgramHandle LoadProgramBinary(uint64_t hash);
+        void SaveProgramBinaries();
+
         void AddFontVertex(FontVertex *&vertex, const float x, const float y, const float u, const float v);
         void AddFontQuad(FontVertex *&vertex, const uint32_t c, const Glyph &glyph,
                            float &cursorX, float &cursorY,
                            const size_t_32 textureW, const size_t_32 textureH);
+        TextureHandle GetFontTexture(size_t_32 page);
 
     private:
         LinearAllocator m_alloc;
         LinearAllocator m_vb_alloc;
         Graphics *m_graphics;
+        MasterCache *m_cache;
 
         GlobalUniforms m_globals;
 
@@ -110,6 +132,25 @@ namespace rob
         VertexBufferHandle      m_vertexBuffer;
         ShaderProgramHandle     m_colorProgram;
         ShaderProgramHandle     m_fontProgram;
+        ShaderProgramHandle     m_textureProgram;
+        /// The shader bound with BindShader.
+        ShaderProgramHandle     m_shader;
+
+        struct CachedProgram
+        {
+            uint64_t m_hash;
+            ShaderProgramHandle m_program;
+            size_t_32 m_references;
+            size_t_32 m_baseUniforms;
+        };
+        static const size_t_32 MAX_CACHED_PROGRAMS = 32;
+        CachedProgram m_programCache[MAX_CACHED_PROGRAMS];
+        size_t_32 m_programCacheCount;
+        MappedFile m_programBinaries;
+
+        FontVertex *m_spriteVertices;
+        size_t_32 m_spriteCount;
+        TextureHandle m_spriteTexture;
 
         Color m_color;
         Font m_font;
@@ -1,14 +1,13 @@
 
 #include "FontCache.h"
-#include "BmfFont.internal.h"
-#include "../util/StreamUtil.h"
+#include "FontFile.internal.h"
 
 #include "MasterCache.h"
 #include "../graphics/Graphics.h"
 #include "../Types.h"
 #include "../Log.h"
 
-#include <fstream>
+#include <cstring>
 
 namespace rob
 {
@@ -20,188 +19,101 @@ namespace rob
 
     ROB_DEFINE_RESOURCE_CACHE_DTOR(FontCache)
 
-    static bool LoadFont(std::istream &in, Font &font, MasterCache *cache);
+    static bool IsInside(const ResourceData &data, uint32_t offset, uint32_t size)
+    { return offset <= data.m_size && size <= data.m_size - offset; }
 
-    bool FontCache::Load(const char * const filename, Font &font)
+    bool FontCache::Decode(const ResourceData &data, Font &font)
     {
-        std::ifstream in(filename, std::ios::binary);
-        if (!in.is_open())
+        FontFileHeader header;
+        if (data.m_size < sizeof(header))
         {
-            log::Error("Could not open font file ", filename);
+            log::Error("Font cache: Invalid font file ", data.m_name);
             return false;
         }
+        std::memcpy(&header, data.m_data, sizeof(header));
 
-        return LoadFont(in, font, m_cache);
-    }
-
-    void FontCache::Unload(Font font)
-    {
-//        for (size_t_32 i = 0; i < font.GetTextureCount(); i++)
-//            m_cache->UnloadTexture(font.GetTexture(i));
-    }
-
-    void ChangePageTextureExtension(char (&buffer)[64])
-    {
-        size_t_32 pos = 0;
-        for (size_t_32 i = 0; i < 64 && buffer[i]; i++)
+        if (header.magic != FontFileHeader::MAGIC)
         {
-            if (buffer[i] == '.') pos = i;
+            log::Error("Font cache: Invalid file header in ", data.m_name);
+            return false;
         }
-        buffer[++pos] = 't';
-        buffer[++pos] = 'e';
-        buffer[++pos] = 'x';
-        buffer[++pos] = '\0';
-    }
-
-    static bool LoadFont(std::istream &in, Font &font, MasterCache *cache)
-    {
-        static constexpr uint8_t BmfVersion = 3;
-
-        if (! (ReadValue<uint8_t>(in) == 'B'
-            && ReadValue<uint8_t>(in) == 'M'
-            && ReadValue<uint8_t>(in) == 'F'))
+        if (header.version != FontFileHeader::VERSION)
         {
-            log::Error("Font cache: Invalid file header.");
+            log::Error("Font cache: Wrong version in ", data.m_name, ". Expected ",
+                       uint32_t(FontFileHeader::VERSION), ", found ", header.version);
             return false;
         }
-
-        const uint8_t version = ReadValue<uint8_t>(in);
-        if (version != BmfVersion)
+        if (header.page_count > Font::MAX_TEXTURE_PAGES
+            || header.directory_size > Font::MAX_GLYPH_BLOCKS
+            || header.block_count >= Font::NO_GLYPH_BLOCK)
         {
-            log::Error("Font cache: Wrong version. Expected ", BmfVersion, ", found ", static_cast<unsigned int>(version));
+            log::Error("Font cache: Too many pages or glyphs in ", data.m_name);
+            return false;
+        }
+        const uint32_t blocksSize = header.block_count * Font::GLYPH_BLOCK_SIZE * sizeof(Glyph);
+        if (!IsInside(data, header.pages_offset, header.page_count * sizeof(uint32_t))
+            || !IsInside(data, header.characters_offset, header.glyph_count * sizeof(uint32_t))
+            || !IsInside(data, header.directory_offset, header.directory_size * sizeof(uint16_t))
+            || !IsInside(data, header.blocks_offset, blocksSize)
+            || (header.characters_offset | header.directory_offset | header.blocks_offset) % FONT_FILE_DATA_ALIGN != 0)
+        {
+            log::Error("Font cache: Corrupted font file ", data.m_name);
             return false;
         }
 
-        size_t_32 pageCount = 0;
-
-        while (in)
+        const uint16_t *directory = reinterpret_cast<const uint16_t*>(data.m_data + header.directory_offset);
+        for (uint32_t i = 0; i < header.directory_size; i++)
         {
-            const uint8_t block_type = ReadValue<uint8_t>(in);
-            if (in.eof()) break;
-            const uint32_t block_size = ReadValue<uint32_t>(in);
+            if (directory[i] != Font::NO_GLYPH_BLOCK && directory[i] >= header.block_count)
+            {
+                log::Error("Font cache: Corrupted glyph directory in ", data.m_name);
+                return false;
+            }
+        }
 
-            switch (block_type)
+        // The glyphs index the texture pages in the renderer, so a glyph
+        // referring to a missing page would read out of bounds.
+        const Glyph *glyphs = reinterpret_cast<const Glyph*>(data.m_data + header.blocks_offset);
+        const uint32_t glyphCount = header.block_count * Font::GLYPH_BLOCK_SIZE;
+        for (uint32_t i = 0; i < glyphCount; i++)
+        {
+            const uint16_t page = glyphs[i].m_textureIdx;
+            if (page != Font::NO_GLYPH && page >= header.page_count)
             {
-            case BmfInfoBlock::TYPE:
-                {
-                    const std::ios::streampos pos = in.tellg();
-                    BmfInfoBlock block;
-                    block.font_size         = ReadValue<int16_t>(in);
-                    block.bit_field         = ReadValue<uint8_t>(in);
-                    block.char_set          = ReadValue<uint8_t>(in);
-                    block.stretch_h         = ReadValue<uint16_t>(in);
-                    block.anti_aliasing     = ReadValue<uint8_t>(in);
-                    block.padding_up        = ReadValue<uint8_t>(in);
-                    block.padding_right     = ReadValue<uint8_t>(in);
-                    block.padding_down      = ReadValue<uint8_t>(in);
-                    block.padding_left      = ReadValue<uint8_t>(in);
-                    block.spacing_horizontal = ReadValue<uint8_t>(in);
-                    block.spacing_vertical  = ReadValue<uint8_t>(in);
-                    block.outline           = ReadValue<uint8_t>(in);
-
-                    // Skip font name
-                    const size_t_32 block_read_size = in.tellg() - pos;
-                    const size_t_32 block_discard_size = block_size - block_read_size;
-                    in.seekg(block_discard_size, std::ios::cur);
-
-                    font.SetLineSpacing(block.spacing_vertical);
-                }
-                break;
-
-            case BmfCommonBlock::TYPE:
-                {
-                    BmfCommonBlock block;
-                    block.line_height    = ReadValue<uint16_t>(in);
-                    block.base           = ReadValue<uint16_t>(in);
-                    block.scale_w        = ReadValue<uint16_t>(in);
-                    block.scale_h        = ReadValue<uint16_t>(in);
-                    block.pages          = ReadValue<uint16_t>(in);
-                    block.bit_field      = ReadValue<uint8_t>(in);
-                    block.alpha_channel  = ReadValue<uint8_t>(in);
-                    block.red_channel    = ReadValue<uint8_t>(in);
-                    block.green_channel  = ReadValue<uint8_t>(in);
-                    block.blue_channel   = ReadValue<uint8_t>(in);
-                    pageCount = block.pages;
-
-                    font.SetBase(block.base);
-                    font.SetHeight(block.line_height);
-                }
-                break;
-
-            case BmfPageBlock::TYPE:
-                {
-                    char pageName[64];
-                    size_t_32 pageNameLen = 0;
-                    const std::ios::streampos startPos = in.tellg();
-                    for (size_t_32 i = 0; i < pageCount; i++)
-                    {
-                        in.seekg(startPos + std::ios::streamoff(i * pageNameLen), std::ios::beg);
-                        size_t_32 len = ReadString(in, pageName);
-                        if (!pageNameLen) pageNameLen = len;
-
-//                        log::Info("FontCache: page: ", pageName, ", id: ", ResourceID(+pageName));
-                        ChangePageTextureExtension(pageName);
-                        // NOTE: To prevent from using the char[64] version, decay to char* by using unary +
-                        const ResourceID texture(+pageName);
-                        font.AddTexture(i, cache->GetTexture(texture));
-//                        log::Info("FontCache: page: ", pageName, ", id: ", texture);
-                    }
-                }
-                break;
-
-            case BmfCharBlock::TYPE:
-                {
-                    const size_t_32 characterCount = block_size / 20;
-                    for (size_t_32 i = 0; i < characterCount; i++)
-                    {
-                        BmfCharBlock block;
-                        block.id        = ReadValue<uint32_t>(in);
-                        block.x         = ReadValue<uint16_t>(in);
-                        block.y         = ReadValue<uint16_t>(in);
-                        block.width     = ReadValue<uint16_t>(in);
-                        block.height    = ReadValue<uint16_t>(in);
-                        block.offset_x  = ReadValue<int16_t>(in);
-                        block.offset_y  = ReadValue<int16_t>(in);
-                        block.advance_x = ReadValue<uint16_t>(in);
-                        block.page      = ReadValue<uint8_t>(in);
-                        block.channel   = ReadValue<uint8_t>(in);
-
-                        Glyph glyph;
-                        glyph.m_x       = block.x;
-                        glyph.m_y       = block.y;
-                        glyph.m_width   = block.width;
-                        glyph.m_height  = block.height;
-                        glyph.m_offsetX = block.offset_x;
-                        glyph.m_offsetY = block.offset_y;
-                        glyph.m_advance = block.advance_x;
-                        glyph.m_textureIdx = block.page;
-
-                        font.AddGlyph(block.id, glyph);
-                    }
-                }
-                break;
-
-            case BmfKerningPairBlock::TYPE:
-                {
-                    in.seekg(block_size, std::ios::cur);
-//                    const size_t_32 kerningPairs = block_size / 10;
-//                    for (size_t_32 i = 0; i < kerningPairs; i++)
-//                    {
-//                        BmfKerningPairBlock block;
-//                        block.first = ReadValue<uint32_t>(in);
-//                        block.second = ReadValue<uint32_t>(in);
-//                        block.amount = ReadValue<int16_t>(in);
-//                        font.AddKerning(block.first, block.second, block.amount);
-//                    }
-                }
-                break;
-
-            default:
-                log::Error("Font cache: Invalid block type ", static_cast<unsigned int>(block_type));
+                log::Error("Font cache: Glyph refers to page ", uint32_t(page), " of ",
+                           header.page_count, " pages in ", data.m_name);
                 return false;
             }
         }
+
+        font.SetBase(header.base);
+        font.SetHeight(header.line_height);
+        font.SetHorizontalSpacing(header.horizontal_spacing);
+        font.SetLineSpacing(header.line_spacing);
+        font.SetTextureSize(header.texture_width, header.texture_height);
+
+        // The tables are used in place from the mapped resource data.
+        font.SetGlyphs(directory, header.directory_size,
+                       glyphs,
+                       reinterpret_cast<const uint32_t*>(data.m_data + header.characters_offset),
+                       header.glyph_count);
+
+        for (uint32_t i = 0; i < header.page_count; i++)
+        {
+            uint32_t id;
+            std::memcpy(&id, data.m_data + header.pages_offset + i * sizeof(id), sizeof(id));
+            font.SetTexturePage(i, ResourceID(id));
+        }
         return true;
     }
 
+    bool FontCache::Load(const ResourceData &data, Font &font)
+    { return Decode(data, font); }
+
+    void FontCache::Unload(Font font)
+    {
+//        for (size_t_32 i = 0; i < font.GetTextureCount(); i++)
+//            m_cache->UnloadTexture(font.GetTexture(i));
+    }
+
 } // rob
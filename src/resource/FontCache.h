@@ -20,11 +20,20 @@ namespace rob
         ~FontCache();
 
         using ResourceCache::Get;
+        using ResourceCache::Contains;
+        using ResourceCache::Find;
+        using ResourceCache::Insert;
         using ResourceCache::UnloadAll;
 
-        bool Load(const char * const filename, Font &font);
+        bool Load(const ResourceData &data, Font &font);
         void Unload(Font font);
 
+        /// Parses the font without loading the page textures, so it can be
+        /// called from any thread. The font uses the glyph tables in place,
+        /// so the data must stay valid as long as the font is used. The page
+        /// textures are loaded by the renderer when first needed.
+        static bool Decode(const ResourceData &data, Font &font);
+
     private:
         Graphics *m_graphics;
         MasterCache *m_cache;
@@ -0,0 +1,45 @@
+
+#ifndef H_ROB_FONT_FILE_INTERNAL_H
+#define H_ROB_FONT_FILE_INTERNAL_H
+
+#include "../renderer/Font.h"
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Header of the .fnt file built by FontBuilder. The header is followed by
+    /// the resource ids of the page textures, the characters of the font in
+    /// ascending order, the glyph block directory and the glyph blocks. The
+    /// directory maps code point >> Font::GLYPH_BLOCK_BITS to a block index
+    /// or to Font::NO_GLYPH_BLOCK. The blocks are arrays of Glyph indexed by
+    /// the lower bits of the code point, so they can be used in place.
+    struct FontFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x544E4652; // "RFNT"
+        static constexpr uint32_t VERSION = 2;
+
+        uint32_t magic;
+        uint32_t version;
+        uint16_t line_height;
+        uint16_t base;
+        uint16_t horizontal_spacing;
+        uint16_t line_spacing;
+        uint16_t texture_width;
+        uint16_t texture_height;
+        uint32_t page_count;
+        uint32_t glyph_count;
+        uint32_t directory_size;
+        uint32_t block_count;
+        /// Offsets from the start of the file.
+        uint32_t pages_offset;
+        uint32_t characters_offset;
+        uint32_t directory_offset;
+        uint32_t blocks_offset;
+    };
+
+    static constexpr uint32_t FONT_FILE_DATA_ALIGN = 4;
+
+} // rob
+
+#endif // H_ROB_FONT_FILE_INTERNAL_H
@@ -1,7 +1,16 @@
 
 #include "MasterCache.h"
-#include "../filesystem/FilesFromDirectory.h"
+#include "PakFile.internal.h"
+#include "../graphics/Graphics.h"
+#include "../graphics/Texture.h"
+#include "../util/MemoryStream.h"
+#include "../util/StreamUtil.h"
 #include "../Log.h"
+#include "../String.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace rob
 {
@@ -10,75 +19,376 @@ namespace rob
         : m_textures(graphics)
         , m_sounds(audio)
         , m_fonts(graphics, this)
-        , m_resources()
+        , m_pak()
+        , m_entries(nullptr)
+        , m_entryCount(0)
+        , m_names(nullptr)
+        , m_atlasRegions()
+        , m_loader()
+        , m_loading()
+        , m_ticker()
     {
-        Scan("data/");
+        m_ticker.Init();
+        OpenPak("data.pak");
     }
 
-    void MasterCache::Scan(const char * const dir)
+    bool MasterCache::OpenPak(const char * const filename)
     {
-        const std::string directory(dir);
-        std::vector<std::string> files;
-        GetFilesFromDirectory(directory, files, true);
+        if (!m_pak.Open(filename))
+        {
+            log::Error("MasterCache: Could not open resource archive ", filename);
+            return false;
+        }
+
+        const uint8_t *data = m_pak.GetData();
+        const size_t_32 size = m_pak.GetSize();
+
+        PakFileHeader header;
+        if (size < sizeof(header))
+        {
+            log::Error("MasterCache: Invalid resource archive ", filename);
+            m_pak.Close();
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
 
-        for (const std::string &file : files)
+        if (header.magic != PakFileHeader::MAGIC || header.version != PakFileHeader::VERSION)
         {
-            ResourceID id(file.c_str());
-            Resource resource;
-            const std::string filepath = directory + file;
-            const size_t_32 len = filepath.length();
-            if (len < sizeof(resource.m_filepath))
+            log::Error("MasterCache: Unsupported resource archive ", filename);
+            m_pak.Close();
+            return false;
+        }
+
+        const size_t_32 namesOffset = sizeof(header) + header.entry_count * sizeof(PakFileEntry);
+        if (namesOffset > size || size - namesOffset < header.names_size
+            || header.names_size == 0 || data[namesOffset + header.names_size - 1] != 0)
+        {
+            log::Error("MasterCache: Invalid resource archive ", filename);
+            m_pak.Close();
+            return false;
+        }
+
+        // The mapping is page aligned and the header size is a multiple of
+        // the entry alignment, so the table of contents is used in place.
+        m_entries = reinterpret_cast<const PakFileEntry*>(data + sizeof(header));
+        m_entryCount = header.entry_count;
+        m_names = reinterpret_cast<const char*>(data + namesOffset);
+
+        for (uint32_t i = 0; i < m_entryCount; i++)
+        {
+            const PakFileEntry &entry = m_entries[i];
+            if (entry.offset > size || size - entry.offset < entry.size
+                || entry.name_offset >= header.names_size)
             {
-                for (size_t_32 i = 0; i < len; i++)
-                    resource.m_filepath[i] = filepath[i];
-                resource.m_filepath[len] = 0;
+                log::Error("MasterCache: Invalid resource entry ", i, " in ", filename);
+                m_entryCount = i;
+                break;
             }
-            else
+
+            const ResourceData resource = GetResourceData(entry);
+            log::Debug("MasterCache: Found: ", resource.m_name, ": ", entry.id);
+
+            static const char atlasExt[] = ".atlas";
+            const size_t_32 extLen = sizeof(atlasExt) - 1;
+            const size_t_32 len = StringLength(resource.m_name);
+            if (len > extLen && std::strcmp(resource.m_name + len - extLen, atlasExt) == 0)
+                LoadAtlasTable(resource);
+        }
+        return true;
+    }
+
+    void MasterCache::LoadAtlasTable(const ResourceData &data)
+    {
+        const char * const filename = data.m_name;
+        MemoryStream in(data.m_data, data.m_size);
+
+        struct Page { ResourceID m_id; uint16_t m_width, m_height; };
+        std::vector<Page> pages(ReadValue<uint32_t>(in));
+        for (Page &page : pages)
+        {
+            page.m_id = ReadValue<uint32_t>(in);
+            page.m_width = ReadValue<uint16_t>(in);
+            page.m_height = ReadValue<uint16_t>(in);
+        }
+
+        const uint32_t regionCount = ReadValue<uint32_t>(in);
+        for (uint32_t i = 0; i < regionCount && in; i++)
+        {
+            const uint32_t id = ReadValue<uint32_t>(in);
+            const uint16_t page = ReadValue<uint16_t>(in);
+            AtlasRegion region;
+            region.m_x = ReadValue<uint16_t>(in);
+            region.m_y = ReadValue<uint16_t>(in);
+            region.m_width = ReadValue<uint16_t>(in);
+            region.m_height = ReadValue<uint16_t>(in);
+            if (page >= pages.size())
             {
-                log::Error("MasterCache: Filepath too long: ", filepath.c_str());
-                continue;
+                log::Error("MasterCache: Invalid atlas page ", page, " in ", filename);
+                return;
             }
-            m_resources[id] = resource;
-            log::Debug("MasterCache: Found: ", filepath.c_str(), ": ", uint32_t(id));
+            region.m_page = pages[page].m_id;
+            region.m_pageWidth = pages[page].m_width;
+            region.m_pageHeight = pages[page].m_height;
+            if (m_atlasRegions.find(id) != m_atlasRegions.end())
+                log::Error("MasterCache: Duplicate atlas region ", id, " in ", filename);
+            m_atlasRegions[id] = region;
         }
+
+        if (!in)
+            log::Error("MasterCache: Invalid atlas ", filename);
     }
 
     TextureHandle MasterCache::GetTexture(ResourceID id)
     {
-        const Resource *resource = nullptr;
-        if (FindResource(id, &resource))
-            return m_textures.Get(id, resource->m_filepath);
+        ResourceData data;
+        if (FindResource(id, data))
+            return m_textures.Get(id, data);
         ReportInvalidResource(id);
         return InvalidHandle;
     }
 
     SoundHandle MasterCache::GetSound(ResourceID id)
     {
-        const Resource *resource = nullptr;
-        if (FindResource(id, &resource))
-            return m_sounds.Get(id, resource->m_filepath);
+        ResourceData data;
+        if (FindResource(id, data))
+            return m_sounds.Get(id, data);
         ReportInvalidResource(id);
         return InvalidSound;
     }
 
+    bool MasterCache::GetSoundStream(ResourceID id, WaveData &wave)
+    {
+        ResourceData data;
+        if (FindResource(id, data))
+            return SoundCache::Decode(data, wave);
+        ReportInvalidResource(id);
+        return false;
+    }
+
     Font MasterCache::GetFont(ResourceID id)
     {
-        const Resource *resource = nullptr;
-        if (FindResource(id, &resource))
-            return m_fonts.Get(id, resource->m_filepath);
+        ResourceData data;
+        if (FindResource(id, data))
+            return m_fonts.Get(id, data);
         ReportInvalidResource(id);
         return Font();
     }
 
-    bool MasterCache::FindResource(ResourceID id, const Resource **resource) const
+    TextureRegion MasterCache::GetTextureRegion(ResourceID id)
+    {
+        TextureRegion region = { };
+        auto it = m_atlasRegions.find(id);
+        if (it != m_atlasRegions.end())
+        {
+            const AtlasRegion &atlas = it->second;
+            // The texture rows are stored from bottom to top, so the v
+            // coordinates are negated like with the font glyphs.
+            region.m_texture = GetTexture(atlas.m_page);
+            region.m_u0 = float(atlas.m_x) / atlas.m_pageWidth;
+            region.m_v0 = -float(atlas.m_y) / atlas.m_pageHeight;
+            region.m_u1 = float(atlas.m_x + atlas.m_width) / atlas.m_pageWidth;
+            region.m_v1 = -float(atlas.m_y + atlas.m_height) / atlas.m_pageHeight;
+            region.m_width = atlas.m_width;
+            region.m_height = atlas.m_height;
+            return region;
+        }
+
+        region.m_texture = GetTexture(id);
+        if (region.m_texture != InvalidHandle)
+        {
+            const Texture *texture = m_textures.GetGraphics()->GetTexture(region.m_texture);
+            region.m_u0 = 0.0f;
+            region.m_v0 = 0.0f;
+            region.m_u1 = 1.0f;
+            region.m_v1 = -1.0f;
+            region.m_width = texture->GetWidth();
+            region.m_height = texture->GetHeight();
+        }
+        return region;
+    }
+
+    static ResourceType GetResourceType(const char *name)
+    {
+        const char *ext = nullptr;
+        for (; *name; name++)
+        {
+            if (*name == '.') ext = name;
+        }
+        if (!ext) return ResourceType::Unknown;
+        if (std::strcmp(ext, ".tex") == 0) return ResourceType::Texture;
+        if (std::strcmp(ext, ".snd") == 0) return ResourceType::Sound;
+        if (std::strcmp(ext, ".fnt") == 0) return ResourceType::Font;
+        return ResourceType::Unknown;
+    }
+
+    TextureHandle MasterCache::GetTextureAsync(ResourceID id)
+    {
+        TextureHandle texture;
+        if (m_textures.Find(id, texture))
+            return texture;
+
+        ResourceData data;
+        if (!FindResource(id, data))
+        {
+            ReportInvalidResource(id);
+            return InvalidHandle;
+        }
+        texture = m_textures.GetGraphics()->CreateTexture();
+        m_textures.Insert(id, texture);
+        StartLoad(id, ResourceType::Texture, data, texture);
+        return texture;
+    }
+
+    SoundHandle MasterCache::GetSoundAsync(ResourceID id)
+    {
+        SoundHandle sound;
+        if (m_sounds.Find(id, sound))
+            return sound;
+
+        ResourceData data;
+        if (!FindResource(id, data))
+        {
+            ReportInvalidResource(id);
+            return InvalidSound;
+        }
+        sound = m_sounds.GetAudio()->CreateSound();
+        m_sounds.Insert(id, sound);
+        StartLoad(id, ResourceType::Sound, data, sound);
+        return sound;
+    }
+
+    void MasterCache::LoadFontAsync(ResourceID id)
+    {
+        if (m_fonts.Contains(id) || m_loading.find(id) != m_loading.end())
+            return;
+
+        ResourceData data;
+        if (!FindResource(id, data))
+        {
+            ReportInvalidResource(id);
+            return;
+        }
+        StartLoad(id, ResourceType::Font, data, InvalidHandle);
+    }
+
+    void MasterCache::Prefetch(const ResourceID *ids, size_t_32 count)
+    {
+        for (size_t_32 i = 0; i < count; i++)
+        {
+            const ResourceID id = ids[i];
+            auto region = m_atlasRegions.find(id);
+            if (region != m_atlasRegions.end())
+            {
+                GetTextureAsync(region->second.m_page);
+                continue;
+            }
+
+            ResourceData data;
+            if (!FindResource(id, data))
+            {
+                ReportInvalidResource(id);
+                continue;
+            }
+
+            switch (GetResourceType(data.m_name))
+            {
+            case ResourceType::Texture: GetTextureAsync(id); break;
+            case ResourceType::Sound:   GetSoundAsync(id); break;
+            case ResourceType::Font:    LoadFontAsync(id); break;
+            default:
+                log::Error("MasterCache: Cannot prefetch ", data.m_name);
+                break;
+            }
+        }
+    }
+
+    bool MasterCache::IsLoaded(ResourceID id) const
     {
-        auto it = m_resources.find(id);
-        if (it == m_resources.end())
+        if (m_loading.find(id) != m_loading.end())
             return false;
-        *resource = &it->second;
+
+        auto region = m_atlasRegions.find(id);
+        if (region != m_atlasRegions.end())
+            return IsLoaded(region->second.m_page);
+
+        return m_textures.Contains(id) || m_sounds.Contains(id) || m_fonts.Contains(id);
+    }
+
+    size_t_32 MasterCache::GetPendingCount() const
+    { return m_loader.GetPendingCount(); }
+
+    void MasterCache::Update(Time_t budget)
+    {
+        const Time_t start = m_ticker.GetTicks();
+        do
+        {
+            LoadJob *job = m_loader.PopCompleted();
+            if (!job) break;
+            FinishLoad(job);
+            ResourceLoader::FreeJob(job);
+        } while (m_ticker.GetTicks() - start < budget);
+    }
+
+    void MasterCache::StartLoad(ResourceID id, ResourceType type, const ResourceData &data, uint32_t handle)
+    {
+        LoadJob *job = new LoadJob();
+        job->m_id = id;
+        job->m_type = type;
+        job->m_data = data;
+        job->m_handle = handle;
+        job->m_decoded = false;
+        m_loading[id] = type;
+        m_loader.Push(job);
+    }
+
+    void MasterCache::FinishLoad(LoadJob *job)
+    {
+        m_loading.erase(job->m_id);
+        // A texture or a sound that failed to decode stays empty.
+        if (!job->m_decoded)
+            return;
+
+        switch (job->m_type)
+        {
+        case ResourceType::Texture:
+            m_textures.Upload(job->m_handle, job->m_texture);
+            break;
+
+        case ResourceType::Sound:
+            m_sounds.GetAudio()->SetSoundData(job->m_handle, job->m_wave);
+            break;
+
+        case ResourceType::Font:
+            // The font may have been loaded synchronously in the meantime.
+            if (!m_fonts.Contains(job->m_id))
+                m_fonts.Insert(job->m_id, job->m_font);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    bool MasterCache::FindResource(ResourceID id, ResourceData &data) const
+    {
+        const PakFileEntry * const end = m_entries + m_entryCount;
+        const PakFileEntry *entry = std::lower_bound(m_entries, end, uint32_t(id),
+            [](const PakFileEntry &e, uint32_t key) { return e.id < key; });
+        if (entry == end || entry->id != id)
+            return false;
+        data = GetResourceData(*entry);
         return true;
     }
 
+    ResourceData MasterCache::GetResourceData(const PakFileEntry &entry) const
+    {
+        ResourceData data;
+        data.m_data = m_pak.GetData() + entry.offset;
+        data.m_size = entry.size;
+        data.m_name = m_names + entry.name_offset;
+        return data;
+    }
+
     void MasterCache::ReportInvalidResource(ResourceID id) const
     {
         log::Info("MasterCache: Invalid reosource id: ", uint32_t(id));
@@ -6,6 +6,10 @@
 #include "TextureCache.h"
 #include "SoundCache.h"
 #include "FontCache.h"
+#include "TextureRegion.h"
+#include "ResourceLoader.h"
+#include "../filesystem/MappedFile.h"
+#include "../time/MicroTicker.h"
 
 #include <unordered_map>
 
@@ -14,31 +18,87 @@ namespace rob
 
     class Graphics;
     class AudioSystem;
+    struct PakFileEntry;
 
     class MasterCache
     {
     public:
         MasterCache(Graphics *graphics, AudioSystem *audio, LinearAllocator &alloc);
+        MasterCache(const MasterCache&) = delete;
+        MasterCache& operator = (const MasterCache&) = delete;
 
         TextureHandle GetTexture(ResourceID id);
         SoundHandle GetSound(ResourceID id);
         Font GetFont(ResourceID id);
 
+        /// Gets the samples of a sound for AudioSystem::PlayStream. Nothing
+        /// is loaded, the samples are read from the archive as they play.
+        bool GetSoundStream(ResourceID id, WaveData &wave);
+
+        /// Returns the region of an image packed to a texture atlas, or the
+        /// whole texture, if the id refers to a texture.
+        TextureRegion GetTextureRegion(ResourceID id);
+
+        /// Returns the handle of the texture immediately. The texture is
+        /// empty until the data is loaded in the background.
+        TextureHandle GetTextureAsync(ResourceID id);
+        /// Returns the handle of the sound immediately. The sound is silent
+        /// until the data is loaded in the background.
+        SoundHandle GetSoundAsync(ResourceID id);
+        /// Starts loading a font in the background. The font can be get with
+        /// GetFont without a hitch, when it is loaded.
+        void LoadFontAsync(ResourceID id);
+
+        /// Starts loading the resources in the background. The type of a
+        /// resource is deduced from its name. Atlas regions load their page.
+        void Prefetch(const ResourceID *ids, size_t_32 count);
+
+        template <size_t_32 N>
+        void Prefetch(const ResourceID (&ids)[N])
+        { Prefetch(ids, N); }
+
+        /// Returns true, if the resource has been loaded.
+        bool IsLoaded(ResourceID id) const;
+        /// Returns the number of background loads not yet completed.
+        size_t_32 GetPendingCount() const;
+
+        /// Uploads the resources loaded in the background. Uploads at least
+        /// one resource and then continues until the time budget given in
+        /// microseconds is used.
+        void Update(Time_t budget);
+
     private:
         TextureCache m_textures;
         SoundCache m_sounds;
         FontCache m_fonts;
 
-        struct Resource
+        MappedFile m_pak;
+        const PakFileEntry *m_entries;
+        uint32_t m_entryCount;
+        const char *m_names;
+
+        struct AtlasRegion
         {
-            char m_filepath[260];
+            ResourceID m_page;
+            uint16_t m_pageWidth, m_pageHeight;
+            uint16_t m_x, m_y;
+            uint16_t m_width, m_height;
         };
-        std::unordered_map<uint32_t, Resource> m_resources;
+        std::unordered_map<uint32_t, AtlasRegion> m_atlasRegions;
+
+        // The loader reads the mapped archive, so it is destroyed first.
+        ResourceLoader m_loader;
+        std::unordered_map<uint32_t, ResourceType> m_loading;
+        MicroTicker m_ticker;
 
     private:
-        void Scan(const char * const dir);
-        bool FindResource(ResourceID id, const Resource **resource) const;
+        bool OpenPak(const char * const filename);
+        void LoadAtlasTable(const ResourceData &data);
+        bool FindResource(ResourceID id, ResourceData &data) const;
+        ResourceData GetResourceData(const PakFileEntry &entry) const;
         void ReportInvalidResource(ResourceID id) const;
+        void StartLoad(ResourceID id, ResourceType type, const ResourceData &data, uint32_t handle);
+        void FinishLoad(LoadJob *job);
     };
 
 } // rob
@@ -0,0 +1,40 @@
+
+#ifndef H_ROB_PAK_FILE_INTERNAL_H
+#define H_ROB_PAK_FILE_INTERNAL_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Header of the .pak resource archive. The header is followed by the
+    /// table of contents sorted by resource id, the block of null terminated
+    /// resource names and the resource data.
+    struct PakFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x4B415052; // "RPAK"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t names_size;
+    };
+
+    struct PakFileEntry
+    {
+        uint32_t id;
+        /// Offset of the name from the start of the name block.
+        uint32_t name_offset;
+        /// Offset of the data from the start of the file.
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /// Alignment of the resource data. The data of the resources can be used
+    /// in place from the mapped file.
+    static constexpr uint32_t PAK_FILE_DATA_ALIGN = 16;
+
+} // rob
+
+#endif // H_ROB_PAK_FILE_INTERNAL_H
@@ -9,6 +9,15 @@
 namespace rob
 {
 
+    /// The data of a resource mapped from the resource archive. The data is
+    /// valid as long as the archive is open.
+    struct ResourceData
+    {
+        const uint8_t *m_data;
+        size_t_32 m_size;
+        const char *m_name;
+    };
+
     template <class T>
     class ResourceCache
     {
@@ -17,18 +26,33 @@ namespace rob
         ResourceCache(const ResourceCache&) = delete;
         ResourceCache& operator = (const ResourceCache&) = delete;
 
-        T Get(ResourceID id, const char * const filename)
+        T Get(ResourceID id, const ResourceData &data)
         {
             auto it = m_resources.find(id);
             if (it != m_resources.end())
                 return it->second;
 
             T resource;
-            if (Load(filename, resource))
+            if (Load(data, resource))
                 m_resources[id] = resource;
             return resource;
         }
 
+        bool Contains(ResourceID id) const
+        { return m_resources.find(id) != m_resources.end(); }
+
+        bool Find(ResourceID id, T &resource) const
+        {
+            auto it = m_resources.find(id);
+            if (it == m_resources.end())
+                return false;
+            resource = it->second;
+            return true;
+        }
+
+        void Insert(ResourceID id, const T &resource)
+        { m_resources[id] = resource; }
+
         void UnloadAll()
         {
             for (auto it : m_resources)
@@ -37,7 +61,7 @@ namespace rob
         }
 
     protected:
-        virtual bool Load(const char * const filename, T &resource) = 0;
+        virtual bool Load(const ResourceData &data, T &resource) = 0;
         virtual void Unload(T resource) = 0;
 
     protected:
@@ -0,0 +1,133 @@
+
+#include "ResourceLoader.h"
+
+#include "../Log.h"
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+namespace rob
+{
+
+    ResourceLoader::ResourceLoader()
+        : m_thread(nullptr)
+        , m_mutex(nullptr)
+        , m_cond(nullptr)
+        , m_queue()
+        , m_completed()
+        , m_quit(false)
+        , m_pending(0)
+    {
+        m_mutex = ::SDL_CreateMutex();
+        m_cond = ::SDL_CreateCond();
+        m_thread = ::SDL_CreateThread(&ResourceLoader::ThreadMain, "ResourceLoader", this);
+        if (!m_thread)
+            log::Error("ResourceLoader: Could not create thread: ", ::SDL_GetError());
+    }
+
+    ResourceLoader::~ResourceLoader()
+    {
+        ::SDL_LockMutex(m_mutex);
+        m_quit = true;
+        ::SDL_CondSignal(m_cond);
+        ::SDL_UnlockMutex(m_mutex);
+        if (m_thread)
+            ::SDL_WaitThread(m_thread, nullptr);
+
+        for (LoadJob *job : m_queue)
+            FreeJob(job);
+        for (LoadJob *job : m_completed)
+            FreeJob(job);
+
+        ::SDL_DestroyCond(m_cond);
+        ::SDL_DestroyMutex(m_mutex);
+    }
+
+    void ResourceLoader::Push(LoadJob *job)
+    {
+        m_pending++;
+        if (!m_thread)
+        {
+            // Without the thread the job is decoded right away.
+            Decode(job);
+            m_completed.push_back(job);
+            return;
+        }
+
+        ::SDL_LockMutex(m_mutex);
+        m_queue.push_back(job);
+        ::SDL_CondSignal(m_cond);
+        ::SDL_UnlockMutex(m_mutex);
+    }
+
+    LoadJob* ResourceLoader::PopCompleted()
+    {
+        LoadJob *job = nullptr;
+        ::SDL_LockMutex(m_mutex);
+        if (!m_completed.empty())
+        {
+            job = m_completed.front();
+            m_completed.pop_front();
+        }
+        ::SDL_UnlockMutex(m_mutex);
+
+        if (job) m_pending--;
+        return job;
+    }
+
+    void ResourceLoader::FreeJob(LoadJob *job)
+    {
+        delete job;
+    }
+
+    int ResourceLoader::ThreadMain(void *loader)
+    {
+        static_cast<ResourceLoader*>(loader)->Run();
+        return 0;
+    }
+
+    void ResourceLoader::Run()
+    {
+        for (;;)
+        {
+            ::SDL_LockMutex(m_mutex);
+            while (m_queue.empty() && !m_quit)
+                ::SDL_CondWait(m_cond, m_mutex);
+            if (m_quit)
+            {
+                ::SDL_UnlockMutex(m_mutex);
+                break;
+            }
+            LoadJob *job = m_queue.front();
+            m_queue.pop_front();
+            ::SDL_UnlockMutex(m_mutex);
+
+            Decode(job);
+
+            ::SDL_LockMutex(m_mutex);
+            m_completed.push_back(job);
+            ::SDL_UnlockMutex(m_mutex);
+        }
+    }
+
+    void ResourceLoader::Decode(LoadJob *job)
+    {
+        const ResourceData &data = job->m_data;
+        switch (job->m_type)
+        {
+        case ResourceType::Texture:
+            job->m_decoded = TextureCache::Decode(data, job->m_texture);
+            break;
+        case ResourceType::Sound:
+            job->m_decoded = SoundCache::Decode(data, job->m_wave);
+            break;
+        case ResourceType::Font:
+            job->m_decoded = FontCache::Decode(data, job->m_font);
+            break;
+        default:
+            job->m_decoded = false;
+            break;
+        }
+    }
+
+} // rob
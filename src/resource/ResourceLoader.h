@@ -0,0 +1,80 @@
+
+#ifndef H_ROB_RESOURCE_LOADER_H
+#define H_ROB_RESOURCE_LOADER_H
+
+#include "TextureCache.h"
+#include "FontCache.h"
+#include "SoundCache.h"
+
+#include <deque>
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+namespace rob
+{
+
+    enum class ResourceType
+    {
+        Unknown,
+        Texture,
+        Sound,
+        Font
+    };
+
+    /// A resource loaded in the background. The loader thread decodes the
+    /// data and the main thread uploads the decoded data to the graphics or
+    /// the audio device.
+    struct LoadJob
+    {
+        ResourceID m_id;
+        ResourceType m_type;
+        ResourceData m_data;
+        /// Texture or sound handle created, when the load was requested.
+        uint32_t m_handle;
+        bool m_decoded;
+
+        TextureImage m_texture;
+        WaveData m_wave;
+        Font m_font;
+    };
+
+    /// Decodes resources in a background thread.
+    class ResourceLoader
+    {
+    public:
+        ResourceLoader();
+        ResourceLoader(const ResourceLoader&) = delete;
+        ResourceLoader& operator = (const ResourceLoader&) = delete;
+        ~ResourceLoader();
+
+        /// Queues the job for decoding. The loader owns the job until it is
+        /// returned by PopCompleted.
+        void Push(LoadJob *job);
+        /// Returns a decoded job or nullptr, if none has been completed.
+        LoadJob* PopCompleted();
+
+        /// Returns the number of jobs pushed, but not yet popped.
+        size_t_32 GetPendingCount() const { return m_pending; }
+
+        static void FreeJob(LoadJob *job);
+
+    private:
+        static int ThreadMain(void *loader);
+        void Run();
+        static void Decode(LoadJob *job);
+
+    private:
+        SDL_Thread *m_thread;
+        SDL_mutex *m_mutex;
+        SDL_cond *m_cond;
+        std::deque<LoadJob*> m_queue;
+        std::deque<LoadJob*> m_completed;
+        bool m_quit;
+        size_t_32 m_pending;
+    };
+
+} // rob
+
+#endif // H_ROB_RESOURCE_LOADER_H
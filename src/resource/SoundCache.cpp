@@ -1,8 +1,11 @@
 
 #include "SoundCache.h"
+#include "SoundFile.internal.h"
 
 #include "../Log.h"
 
+#include <cstring>
+
 namespace rob
 {
 
@@ -12,9 +15,48 @@ namespace rob
 
     ROB_DEFINE_RESOURCE_CACHE_DTOR(SoundCache)
 
-    bool SoundCache::Load(const char * const filename, SoundHandle &sound)
+    bool SoundCache::Decode(const ResourceData &data, WaveData &wave)
     {
-        return (sound = m_audio->LoadSound(filename)) != InvalidSound;
+        SoundFileHeader header;
+        if (data.m_size < sizeof(header))
+        {
+            log::Error("Sound cache: Invalid sound file ", data.m_name);
+            return false;
+        }
+        std::memcpy(&header, data.m_data, sizeof(header));
+
+        if (header.magic != SoundFileHeader::MAGIC || header.version != SoundFileHeader::VERSION)
+        {
+            log::Error("Sound cache: Invalid file header or version in ", data.m_name);
+            return false;
+        }
+        if (header.data_offset > data.m_size || header.data_size > data.m_size - header.data_offset)
+        {
+            log::Error("Sound cache: Corrupted sound file ", data.m_name);
+            return false;
+        }
+
+        wave.m_samples = data.m_data + header.data_offset;
+        wave.m_size = header.data_size;
+        wave.m_channels = header.channels;
+        wave.m_bitsPerSample = header.bits_per_sample;
+        wave.m_frequency = header.frequency;
+        return true;
+    }
+
+    bool SoundCache::Load(const ResourceData &data, SoundHandle &sound)
+    {
+        WaveData wave;
+        if (!Decode(data, wave))
+            return false;
+
+        sound = m_audio->CreateSound();
+        if (!m_audio->SetSoundData(sound, wave))
+        {
+            m_audio->UnloadSound(sound);
+            return false;
+        }
+        return true;
     }
 
     void SoundCache::Unload(SoundHandle sound)
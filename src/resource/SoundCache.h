@@ -17,11 +17,20 @@ namespace rob
         ~SoundCache();
 
         using ResourceCache::Get;
+        using ResourceCache::Contains;
+        using ResourceCache::Find;
+        using ResourceCache::Insert;
         using ResourceCache::UnloadAll;
 
-        bool Load(const char * const filename, SoundHandle &sound);
+        bool Load(const ResourceData &data, SoundHandle &sound);
         void Unload(SoundHandle sound);
 
+        AudioSystem* GetAudio() { return m_audio; }
+
+        /// Reads the sample format of the sound. The samples are used in
+        /// place, so this can be called from any thread.
+        static bool Decode(const ResourceData &data, WaveData &wave);
+
     private:
         AudioSystem *m_audio;
     };
@@ -0,0 +1,32 @@
+
+#ifndef H_ROB_SOUND_FILE_INTERNAL_H
+#define H_ROB_SOUND_FILE_INTERNAL_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Header of the .snd file built by SoundBuilder. The header is followed
+    /// by the interleaved PCM samples, which are given to the audio device
+    /// as is.
+    struct SoundFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x444E5352; // "RSND"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t frequency;
+        uint16_t channels;
+        uint16_t bits_per_sample;
+        /// Offset of the samples from the start of the file.
+        uint32_t data_offset;
+        uint32_t data_size;
+    };
+
+    static constexpr uint32_t SOUND_FILE_DATA_ALIGN = 16;
+
+} // rob
+
+#endif // H_ROB_SOUND_FILE_INTERNAL_H
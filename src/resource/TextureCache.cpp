@@ -2,11 +2,11 @@
 #include "TextureCache.h"
 #include "../graphics/Graphics.h"
 #include "../graphics/Texture.h"
-#include "../memory/LinearAllocator.h"
+#include "../util/Lz4.h"
 
 #include "../Log.h"
 
-#include <fstream>
+#include <cstring>
 
 namespace rob
 {
@@ -17,41 +17,144 @@ namespace rob
 
     ROB_DEFINE_RESOURCE_CACHE_DTOR(TextureCache)
 
-    bool TextureCache::Load(const char * const filename, TextureHandle &texture)
+    /// Checks the format and the dimensions of the image and returns the
+    /// size of the mip level in bytes, or zero if the image is invalid.
+    static size_t_32 GetMipSize(uint32_t width, uint32_t height, uint32_t format, uint32_t level)
     {
-        std::ifstream in(filename, std::ios_base::binary);
-        if (!in.is_open())
+        if (format != Texture::FMT_LUMINANCE && format != Texture::FMT_RGB && format != Texture::FMT_RGBA)
+            return 0;
+        if (width == 0 || width > TEXTURE_FILE_MAX_SIZE || height == 0 || height > TEXTURE_FILE_MAX_SIZE)
+            return 0;
+        const uint32_t w = (width >> level) > 0 ? (width >> level) : 1;
+        const uint32_t h = (height >> level) > 0 ? (height >> level) : 1;
+        return w * h * format;
+    }
+
+    static bool DecodeV1(const uint8_t *data, size_t_32 size, TextureImage &image)
+    {
+        size_t_32 header[3];
+        if (size < sizeof(header))
+            return false;
+        std::memcpy(header, data, sizeof(header));
+
+        image.m_width = header[0];
+        image.m_height = header[1];
+        image.m_format = header[2];
+        image.m_mipCount = 1;
+        image.m_mips[0] = data + sizeof(header);
+        const size_t_32 imageSize = GetMipSize(image.m_width, image.m_height, image.m_format, 0);
+        return imageSize > 0 && size - sizeof(header) >= imageSize;
+    }
+
+    static bool DecodeV2(const uint8_t *data, size_t_32 size, TextureImage &image, const char * const filename)
+    {
+        TextureFileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.version != TextureFileHeader::VERSION)
         {
-            log::Error("Could not open texture file ", filename);
-            return InvalidHandle;
+            log::Error("Unsupported texture file version ", header.version, " in ", filename);
+            return false;
         }
-
-        size_t_32 width = 0;
-        size_t_32 height = 0;
-        size_t_32 st_format = 0;
-        in.read(reinterpret_cast<char*>(&width), sizeof(size_t_32));
-        in.read(reinterpret_cast<char*>(&height), sizeof(size_t_32));
-        in.read(reinterpret_cast<char*>(&st_format), sizeof(size_t_32));
-        if (!in)
+        if (header.mip_count == 0 || header.mip_count > TEXTURE_FILE_MAX_MIPS
+            || size < sizeof(header) + header.mip_count * sizeof(TextureFileMip))
         {
-            log::Error("Invalid texture file ", filename);
-            texture = InvalidHandle;
             return false;
         }
-        const size_t_32 imageSize = width * height * st_format;
 
-        const size_t_32 IMAGE_DATA_ALIGN = 4;
-        LinearAllocator alloc(imageSize + IMAGE_DATA_ALIGN - 1);
-        char *imageData = static_cast<char*>(alloc.Allocate(imageSize, IMAGE_DATA_ALIGN));
+        TextureFileMip mips[TEXTURE_FILE_MAX_MIPS];
+        std::memcpy(mips, data + sizeof(header), header.mip_count * sizeof(TextureFileMip));
 
-        in.read(imageData, imageSize);
+        // The mip levels are uploaded with the sizes computed from the
+        // header, so each level must hold exactly that much data. The limits
+        // on the dimensions keep the sum of the sizes from overflowing.
+        size_t_32 compressedSize = 0;
+        for (uint32_t i = 0; i < header.mip_count; i++)
+        {
+            const TextureFileMip &mip = mips[i];
+            const size_t_32 mipSize = GetMipSize(header.width, header.height, header.format, i);
+            if (mipSize == 0 || mip.size != mipSize)
+                return false;
+            if (mip.stored_size > mip.size)
+                return false;
+            if (mip.offset > size || size - mip.offset < mip.stored_size)
+                return false;
+            if (mip.stored_size != mip.size)
+                compressedSize += mip.size;
+        }
 
-        texture = m_graphics->CreateTexture();
+        // Only the compressed mip levels need a buffer, the others are
+        // uploaded straight from the resource data.
+        image.m_buffer.resize(compressedSize);
+        uint8_t *buffer = image.m_buffer.data();
+
+        image.m_width = header.width;
+        image.m_height = header.height;
+        image.m_format = header.format;
+        image.m_mipCount = header.mip_count;
+        for (uint32_t i = 0; i < header.mip_count; i++)
+        {
+            const TextureFileMip &mip = mips[i];
+            image.m_mips[i] = data + mip.offset;
+            if (mip.stored_size != mip.size)
+            {
+                if (!Lz4Decompress(data + mip.offset, mip.stored_size, buffer, mip.size))
+                {
+                    log::Error("Corrupted mip level ", i, " in texture file ", filename);
+                    return false;
+                }
+                image.m_mips[i] = buffer;
+                buffer += mip.size;
+            }
+        }
+        return true;
+    }
+
+    bool TextureCache::Decode(const ResourceData &resource, TextureImage &image)
+    {
+        const uint8_t *data = resource.m_data;
+        const size_t_32 size = resource.m_size;
+
+        uint32_t magic = 0;
+        if (size >= sizeof(TextureFileHeader))
+            std::memcpy(&magic, data, sizeof(magic));
+
+        const bool result = (magic == TextureFileHeader::MAGIC)
+            ? DecodeV2(data, size, image, resource.m_name)
+            : DecodeV1(data, size, image);
+        if (!result)
+            log::Error("Invalid texture file ", resource.m_name);
+        return result;
+    }
+
+    void TextureCache::Upload(TextureHandle texture, const TextureImage &image)
+    {
         m_graphics->BindTexture(0, texture);
         Texture *t = m_graphics->GetTexture(texture);
-        t->TexImage(width, height, static_cast<Texture::Format>(st_format), imageData);
+
+        size_t_32 w = image.m_width;
+        size_t_32 h = image.m_height;
+        t->TexImage(w, h, static_cast<Texture::Format>(image.m_format), image.m_mips[0]);
+        for (uint32_t i = 1; i < image.m_mipCount; i++)
+        {
+            w = (w > 1) ? w / 2 : 1;
+            h = (h > 1) ? h / 2 : 1;
+            t->TexMipImage(i, w, h, image.m_mips[i]);
+        }
+        t->SetMipLevels(image.m_mipCount);
+
         m_graphics->BindTexture(0, InvalidHandle);
+    }
 
+    bool TextureCache::Load(const ResourceData &data, TextureHandle &texture)
+    {
+        TextureImage image;
+        if (!Decode(data, image))
+        {
+            texture = InvalidHandle;
+            return false;
+        }
+        texture = m_graphics->CreateTexture();
+        Upload(texture, image);
         return true;
     }
 
@@ -3,13 +3,28 @@
 #define H_ROB_TEXTURE_CACHE_H
 
 #include "ResourceCache.h"
+#include "TextureFile.internal.h"
 #include "../graphics/GraphicsTypes.h"
 
+#include <vector>
+
 namespace rob
 {
 
     class Graphics;
 
+    /// Texture file decoded to mip level images ready for the upload. The
+    /// uncompressed levels point to the resource data.
+    struct TextureImage
+    {
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_format;
+        uint32_t m_mipCount;
+        const uint8_t *m_mips[TEXTURE_FILE_MAX_MIPS];
+        std::vector<uint8_t> m_buffer;
+    };
+
     class TextureCache : private ResourceCache<TextureHandle>
     {
     public:
@@ -19,11 +34,21 @@ namespace rob
         ~TextureCache();
 
         using ResourceCache::Get;
+        using ResourceCache::Contains;
+        using ResourceCache::Find;
+        using ResourceCache::Insert;
         using ResourceCache::UnloadAll;
 
-        bool Load(const char * const filename, TextureHandle &texture);
+        bool Load(const ResourceData &data, TextureHandle &texture);
         void Unload(TextureHandle texture);
 
+        /// Decodes the texture data. Does not touch the graphics, so it can
+        /// be called from any thread.
+        static bool Decode(const ResourceData &data, TextureImage &image);
+        void Upload(TextureHandle texture, const TextureImage &image);
+
+        Graphics* GetGraphics() { return m_graphics; }
+
     private:
         Graphics *m_graphics;
     };
@@ -0,0 +1,44 @@
+
+#ifndef H_ROB_TEXTURE_FILE_INTERNAL_H
+#define H_ROB_TEXTURE_FILE_INTERNAL_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Header of the version 2 .tex file. The header is followed by mip level
+    /// descriptions and the mip level data. The version 1 files have no magic
+    /// and start with the width, height and format followed by raw pixels.
+    struct TextureFileHeader
+    {
+        static constexpr uint32_t MAGIC = 0x58455452; // "RTEX"
+        static constexpr uint32_t VERSION = 2;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint32_t mip_count;
+        uint32_t flags;
+    };
+
+    struct TextureFileMip
+    {
+        /// Offset of the data from the start of the file.
+        uint32_t offset;
+        /// Size of the data in the file. If it is less than size, the data
+        /// is LZ4 compressed.
+        uint32_t stored_size;
+        uint32_t size;
+    };
+
+    static constexpr uint32_t TEXTURE_FILE_MAX_MIPS = 16;
+    /// Maximum width and height. Keeps the image sizes in 32 bits.
+    static constexpr uint32_t TEXTURE_FILE_MAX_SIZE = 16384;
+    static constexpr uint32_t TEXTURE_FILE_DATA_ALIGN = 4;
+
+} // rob
+
+#endif // H_ROB_TEXTURE_FILE_INTERNAL_H
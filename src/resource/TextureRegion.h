@@ -0,0 +1,24 @@
+
+#ifndef H_ROB_TEXTURE_REGION_H
+#define H_ROB_TEXTURE_REGION_H
+
+#include "../graphics/GraphicsTypes.h"
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// A sub-rectangle of a texture, e.g. an image packed to a texture atlas.
+    struct TextureRegion
+    {
+        TextureHandle m_texture;
+        // Texture coordinates of the top left and bottom right corners
+        float m_u0, m_v0;
+        float m_u1, m_v1;
+        // Size in texels
+        uint16_t m_width, m_height;
+    };
+
+} // rob
+
+#endif // H_ROB_TEXTURE_REGION_H
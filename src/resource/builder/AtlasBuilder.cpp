@@ -0,0 +1,292 @@
+
+#include "AtlasBuilder.h"
+#include "Image.h"
+#include "../ResourceID.h"
+#include "../../util/StreamUtil.h"
+#include "../../Log.h"
+#include "../../Types.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace rob
+{
+
+    static const char * const ATLAS_EXTENSION = ".atlas";
+    static const int ATLAS_PAGE_SIZE = 1024;
+    // Each image is surrounded by a border of its edge texels to avoid
+    // bleeding of the neighbouring images with bilinear filtering.
+    static const int ATLAS_BORDER = 1;
+
+    struct AtlasRect
+    {
+        int x, y, w, h;
+    };
+
+    /// Bin packer using the maximal rectangles algorithm with best short
+    /// side fit heuristic.
+    class MaxRectsPacker
+    {
+    public:
+        explicit MaxRectsPacker(int size)
+            : m_free()
+        {
+            m_free.push_back(AtlasRect{ 0, 0, size, size });
+        }
+
+        bool Insert(int w, int h, AtlasRect &result)
+        {
+            int bestShortSide = ATLAS_PAGE_SIZE + 1;
+            int bestLongSide = ATLAS_PAGE_SIZE + 1;
+            const AtlasRect *best = nullptr;
+            for (const AtlasRect &r : m_free)
+            {
+                if (r.w < w || r.h < h) continue;
+                const int shortSide = std::min(r.w - w, r.h - h);
+                const int longSide = std::max(r.w - w, r.h - h);
+                if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+                {
+                    bestShortSide = shortSide;
+                    bestLongSide = longSide;
+                    best = &r;
+                }
+            }
+            if (!best)
+                return false;
+
+            result = AtlasRect{ best->x, best->y, w, h };
+            Split(result);
+            Prune();
+            return true;
+        }
+
+    private:
+        static bool Intersects(const AtlasRect &a, const AtlasRect &b)
+        {
+            return a.x < b.x + b.w && b.x < a.x + a.w
+                && a.y < b.y + b.h && b.y < a.y + a.h;
+        }
+
+        static bool Contains(const AtlasRect &a, const AtlasRect &b)
+        {
+            return b.x >= a.x && b.y >= a.y
+                && b.x + b.w <= a.x + a.w && b.y + b.h <= a.y + a.h;
+        }
+
+        void Split(const AtlasRect &used)
+        {
+            std::vector<AtlasRect> split;
+            for (size_t_32 i = 0; i < m_free.size(); )
+            {
+                const AtlasRect r = m_free[i];
+                if (!Intersects(r, used))
+                {
+                    i++;
+                    continue;
+                }
+                if (used.x > r.x)
+                    split.push_back(AtlasRect{ r.x, r.y, used.x - r.x, r.h });
+                if (used.x + used.w < r.x + r.w)
+                    split.push_back(AtlasRect{ used.x + used.w, r.y, r.x + r.w - used.x - used.w, r.h });
+                if (used.y > r.y)
+                    split.push_back(AtlasRect{ r.x, r.y, r.w, used.y - r.y });
+                if (used.y + used.h < r.y + r.h)
+                    split.push_back(AtlasRect{ r.x, used.y + used.h, r.w, r.y + r.h - used.y - used.h });
+                m_free[i] = m_free.back();
+                m_free.pop_back();
+            }
+            m_free.insert(m_free.end(), split.begin(), split.end());
+        }
+
+        void Prune()
+        {
+            for (size_t_32 i = 0; i < m_free.size(); i++)
+            {
+                for (size_t_32 j = i + 1; j < m_free.size(); j++)
+                {
+                    if (Contains(m_free[j], m_free[i]))
+                    {
+                        m_free.erase(m_free.begin() + i);
+                        i--;
+                        break;
+                    }
+                    if (Contains(m_free[i], m_free[j]))
+                    {
+                        m_free.erase(m_free.begin() + j);
+                        j--;
+                    }
+                }
+            }
+        }
+
+    private:
+        std::vector<AtlasRect> m_free;
+    };
+
+    struct AtlasImage
+    {
+        std::string m_name;
+        Image m_image;
+        size_t_32 m_page;
+        AtlasRect m_rect;
+    };
+
+    static void BlitImage(const Image &image, const AtlasRect &rect, Image &page)
+    {
+        const int pageW = page.m_width;
+        const int srcW = image.m_width;
+        const int srcH = image.m_height;
+        const size_t_32 srcBpp = image.GetBytesPerPixel();
+
+        for (int y = 0; y < rect.h; y++)
+        {
+            // Clamp to the edges of the image for the border texels.
+            const int sy = std::min(std::max(y - ATLAS_BORDER, 0), srcH - 1);
+            for (int x = 0; x < rect.w; x++)
+            {
+                const int sx = std::min(std::max(x - ATLAS_BORDER, 0), srcW - 1);
+                const uint8_t *src = &image.m_pixels[(sy * srcW + sx) * srcBpp];
+                uint8_t *dest = &page.m_pixels[((rect.y + y) * pageW + rect.x + x) * 4];
+                dest[0] = src[0];
+                dest[1] = src[1];
+                dest[2] = src[2];
+                dest[3] = (srcBpp == 4) ? src[3] : 255;
+            }
+        }
+    }
+
+    static std::string GetPageName(const std::string &atlasName, size_t_32 page)
+    { return atlasName + "_" + std::to_string(page) + ".tex"; }
+
+    std::string AtlasBuilder::GetTableName(const std::string &atlasName)
+    { return atlasName + ATLAS_EXTENSION; }
+
+    bool AtlasBuilder::IsAtlasImage(const std::string &file, std::string &atlasName)
+    {
+        // The outermost .atlas directory on the path holds the atlas, so the
+        // images can be organized to subdirectories inside it.
+        const size_t_32 extLen = std::char_traits<char>::length(ATLAS_EXTENSION);
+        std::string::size_type start = 0;
+        std::string::size_type slash = file.find('/');
+        while (slash != std::string::npos)
+        {
+            const std::string::size_type dirLen = slash - start;
+            if (dirLen > extLen && file.compare(slash - extLen, extLen, ATLAS_EXTENSION) == 0)
+            {
+                atlasName = file.substr(0, slash - extLen);
+                return true;
+            }
+            start = slash + 1;
+            slash = file.find('/', start);
+        }
+        return false;
+    }
+
+    bool AtlasBuilder::Build(const std::string &atlasName, const std::vector<std::string> &files,
+                             const std::string &directory, const std::string &destDirectory)
+    {
+        const std::string tableFile = destDirectory + "/" + GetTableName(atlasName);
+
+        // The images are named by their path inside the atlas directory.
+        const std::string::size_type atlasDirLen = GetTableName(atlasName).length() + 1;
+        std::vector<AtlasImage> images(files.size());
+        for (size_t_32 i = 0; i < files.size(); i++)
+        {
+            const std::string &file = files[i];
+            images[i].m_name = file.substr(atlasDirLen);
+            if (!LoadImage(directory + "/" + file, images[i].m_image))
+                return false;
+        }
+
+        // Packing the largest images first gives tighter pages.
+        std::sort(images.begin(), images.end(), [](const AtlasImage &a, const AtlasImage &b)
+        {
+            return std::max(a.m_image.m_width, a.m_image.m_height)
+                 > std::max(b.m_image.m_width, b.m_image.m_height);
+        });
+
+        std::vector<MaxRectsPacker> packers;
+        for (AtlasImage &image : images)
+        {
+            const int w = image.m_image.m_width + 2 * ATLAS_BORDER;
+            const int h = image.m_image.m_height + 2 * ATLAS_BORDER;
+            if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE)
+            {
+                log::Error("AtlasBuilder: Image ", image.m_name.c_str(), " is larger than the atlas page");
+                return false;
+            }
+
+            size_t_32 page = 0;
+            for (; page < packers.size(); page++)
+            {
+                if (packers[page].Insert(w, h, image.m_rect))
+                    break;
+            }
+            if (page == packers.size())
+            {
+                packers.push_back(MaxRectsPacker(ATLAS_PAGE_SIZE));
+                packers.back().Insert(w, h, image.m_rect);
+            }
+            image.m_page = page;
+        }
+
+        std::vector<Image> pages(packers.size());
+        for (Image &page : pages)
+        {
+            page.m_width = ATLAS_PAGE_SIZE;
+            page.m_height = ATLAS_PAGE_SIZE;
+            page.m_format = Texture::FMT_RGBA;
+            page.m_pixels.resize(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+        }
+        for (const AtlasImage &image : images)
+            BlitImage(image.m_image, image.m_rect, pages[image.m_page]);
+
+        // The sprites are mostly drawn at their native size and the mip levels
+        // would bleed over the borders of the packed images.
+        TextureOptions options;
+        options.m_mipmaps = false;
+        for (size_t_32 i = 0; i < pages.size(); i++)
+        {
+            if (!WriteTexture(destDirectory + "/" + GetPageName(atlasName, i), pages[i], options))
+                return false;
+        }
+
+        std::ofstream out(tableFile.c_str(), std::ios_base::binary);
+        if (!out.is_open())
+        {
+            log::Error("AtlasBuilder: Could not open the destination file ", tableFile.c_str());
+            return false;
+        }
+
+        WriteValue<uint32_t>(out, pages.size());
+        for (size_t_32 i = 0; i < pages.size(); i++)
+        {
+            const std::string pageName = GetPageName(atlasName, i);
+            WriteValue<uint32_t>(out, ResourceID(pageName.c_str()));
+            WriteValue<uint16_t>(out, ATLAS_PAGE_SIZE);
+            WriteValue<uint16_t>(out, ATLAS_PAGE_SIZE);
+        }
+
+        WriteValue<uint32_t>(out, images.size());
+        for (const AtlasImage &image : images)
+        {
+            WriteValue<uint32_t>(out, ResourceID(image.m_name.c_str()));
+            WriteValue<uint16_t>(out, image.m_page);
+            WriteValue<uint16_t>(out, image.m_rect.x + ATLAS_BORDER);
+            WriteValue<uint16_t>(out, image.m_rect.y + ATLAS_BORDER);
+            WriteValue<uint16_t>(out, image.m_image.m_width);
+            WriteValue<uint16_t>(out, image.m_image.m_height);
+        }
+
+        if (!out)
+        {
+            log::Error("AtlasBuilder: Could not write ", tableFile.c_str());
+            return false;
+        }
+
+        log::Info("Built atlas ", atlasName.c_str(), ": ", images.size(), " images to ",
+                  pages.size(), " pages");
+        return true;
+    }
+
+} // rob
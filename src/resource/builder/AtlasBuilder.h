@@ -0,0 +1,35 @@
+
+#ifndef H_ROB_ATLAS_BUILDER_H
+#define H_ROB_ATLAS_BUILDER_H
+
+#include "../../Types.h"
+
+#include <string>
+#include <vector>
+
+namespace rob
+{
+
+    /// Packs the images of a source directory named "<name>.atlas" to shared
+    /// texture pages "<name>_<page>.tex" and writes a region table "<name>.atlas",
+    /// which maps the image file names to sub-rectangles of the pages.
+    class AtlasBuilder
+    {
+    public:
+        static const uint32_t VERSION = 1;
+
+        /// Returns the file name of the region table of the atlas.
+        static std::string GetTableName(const std::string &atlasName);
+
+        /// Returns true, if the file belongs to an atlas directory at any depth
+        /// and sets the name of the atlas, i.e. the path of the directory
+        /// without the extension.
+        static bool IsAtlasImage(const std::string &file, std::string &atlasName);
+
+        bool Build(const std::string &atlasName, const std::vector<std::string> &files,
+                   const std::string &directory, const std::string &destDirectory);
+    };
+
+} // rob
+
+#endif // H_ROB_ATLAS_BUILDER_H
@@ -0,0 +1,194 @@
+
+#include "BuildDatabase.h"
+#include "../../filesystem/FileStat.h"
+#include "../../util/StreamUtil.h"
+#include "../../Assert.h"
+#include "../../Log.h"
+
+#include <fstream>
+
+namespace rob
+{
+
+    static const uint32_t BUILD_DATABASE_MAGIC = 0x42444252; // "RBDB"
+    static const uint32_t BUILD_DATABASE_VERSION = 1;
+
+    static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+    static const uint64_t FNV_PRIME = 1099511628211ull;
+
+    static uint64_t HashBytes(uint64_t hash, const char *data, size_t_32 size)
+    {
+        for (size_t_32 i = 0; i < size; i++)
+        {
+            hash ^= uint8_t(data[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    static uint64_t HashString(uint64_t hash, const std::string &str)
+    { return HashBytes(hash, str.c_str(), str.length() + 1); }
+
+    /// Hashes the names and modification times of the sources.
+    static uint64_t GetTimeStamp(const std::vector<std::string> &sources)
+    {
+        uint64_t hash = FNV_OFFSET;
+        for (const std::string &source : sources)
+        {
+            const int64_t time = GetModifyTime(source.c_str());
+            hash = HashString(hash, source);
+            hash = HashBytes(hash, reinterpret_cast<const char*>(&time), sizeof(time));
+        }
+        return hash;
+    }
+
+    /// Hashes the names and contents of the sources.
+    static uint64_t GetContentHash(const std::vector<std::string> &sources)
+    {
+        uint64_t hash = FNV_OFFSET;
+        for (const std::string &source : sources)
+        {
+            hash = HashString(hash, source);
+            std::ifstream in(source.c_str(), std::ios::binary);
+            char buffer[4096];
+            while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+                hash = HashBytes(hash, buffer, in.gcount());
+        }
+        return hash;
+    }
+
+    static void WriteString(std::ostream &out, const std::string &str)
+    {
+        WriteValue<uint32_t>(out, str.length());
+        out.write(str.c_str(), str.length());
+    }
+
+    static bool ReadString(std::istream &in, std::string &str)
+    {
+        const uint32_t len = ReadValue<uint32_t>(in);
+        if (!in || len > 4096)
+            return false;
+        str.resize(len);
+        in.read(&str[0], len);
+        return bool(in);
+    }
+
+    BuildDatabase::BuildDatabase()
+        : m_entries()
+    { }
+
+    bool BuildDatabase::Load(const std::string &filename)
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        if (ReadValue<uint32_t>(in) != BUILD_DATABASE_MAGIC ||
+            ReadValue<uint32_t>(in) != BUILD_DATABASE_VERSION)
+        {
+            log::Info("BuildDatabase: Ignoring old database ", filename.c_str());
+            return false;
+        }
+
+        const uint32_t count = ReadValue<uint32_t>(in);
+        for (uint32_t i = 0; i < count && in; i++)
+        {
+            std::string output;
+            if (!ReadString(in, output))
+                break;
+            Entry entry;
+            entry.m_timeStamp = ReadValue<uint64_t>(in);
+            entry.m_contentHash = ReadValue<uint64_t>(in);
+            entry.m_version = ReadValue<uint32_t>(in);
+            entry.m_used = false;
+            m_entries[output] = entry;
+        }
+
+        if (!in)
+        {
+            log::Error("BuildDatabase: Corrupted database ", filename.c_str());
+            m_entries.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool BuildDatabase::Save(const std::string &filename) const
+    {
+        std::ofstream out(filename.c_str(), std::ios::binary);
+        if (!out.is_open())
+        {
+            log::Error("BuildDatabase: Could not open ", filename.c_str(), " for writing");
+            return false;
+        }
+
+        uint32_t count = 0;
+        for (const auto &it : m_entries)
+            if (it.second.m_used) count++;
+
+        WriteValue<uint32_t>(out, BUILD_DATABASE_MAGIC);
+        WriteValue<uint32_t>(out, BUILD_DATABASE_VERSION);
+        WriteValue<uint32_t>(out, count);
+        for (const auto &it : m_entries)
+        {
+            const Entry &entry = it.second;
+            if (!entry.m_used) continue;
+            WriteString(out, it.first);
+            WriteValue<uint64_t>(out, entry.m_timeStamp);
+            WriteValue<uint64_t>(out, entry.m_contentHash);
+            WriteValue<uint32_t>(out, entry.m_version);
+        }
+        return bool(out);
+    }
+
+    bool BuildDatabase::IsUpToDate(const std::string &output, const std::vector<std::string> &sources, uint32_t version)
+    {
+        auto it = m_entries.find(output);
+        if (it == m_entries.end())
+            return false;
+
+        Entry &entry = it->second;
+        entry.m_used = true;
+        if (entry.m_version != version || !FileExists(output.c_str()))
+            return false;
+
+        const uint64_t timeStamp = GetTimeStamp(sources);
+        if (entry.m_timeStamp == timeStamp)
+            return true;
+
+        // The sources were touched, but the content may still be the same.
+        if (entry.m_contentHash != GetContentHash(sources))
+            return false;
+        entry.m_timeStamp = timeStamp;
+        return true;
+    }
+
+    bool BuildDatabase::IsUpToDate(const std::string &output, const std::string &source, uint32_t version)
+    { return IsUpToDate(output, std::vector<std::string>(1, source), version); }
+
+    bool BuildDatabase::IsUpToDate(const std::vector<std::string> &outputs, const std::vector<std::string> &sources, uint32_t version)
+    {
+        ROB_ASSERT(!outputs.empty());
+        if (!IsUpToDate(outputs[0], sources, version))
+            return false;
+        for (size_t_32 i = 1; i < outputs.size(); i++)
+        {
+            if (!FileExists(outputs[i].c_str()))
+                return false;
+        }
+        return true;
+    }
+
+    void BuildDatabase::Record(const std::string &output, const std::vector<std::string> &sources, uint32_t version)
+    {
+        Entry &entry = m_entries[output];
+        entry.m_timeStamp = GetTimeStamp(sources);
+        entry.m_contentHash = GetContentHash(sources);
+        entry.m_version = version;
+        entry.m_used = true;
+    }
+
+    void BuildDatabase::Record(const std::string &output, const std::string &source, uint32_t version)
+    { Record(output, std::vector<std::string>(1, source), version); }
+
+} // rob
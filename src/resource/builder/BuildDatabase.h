@@ -0,0 +1,59 @@
+
+#ifndef H_ROB_BUILD_DATABASE_H
+#define H_ROB_BUILD_DATABASE_H
+
+#include "../../Types.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rob
+{
+
+    struct BuildReport
+    {
+        size_t_32 m_built;
+        size_t_32 m_skipped;
+        size_t_32 m_failed;
+    };
+
+    /// Records the sources and the builder version of each built output, so
+    /// that only the outputs with changed sources are rebuilt. The sources are
+    /// compared by modification time first and by content hash, if the time
+    /// has changed.
+    class BuildDatabase
+    {
+    public:
+        BuildDatabase();
+
+        bool Load(const std::string &filename);
+        /// Saves the outputs checked or recorded since loading. The outputs
+        /// of removed sources are dropped.
+        bool Save(const std::string &filename) const;
+
+        /// Returns true, if the output exists and was built from the same
+        /// sources with the same builder version.
+        bool IsUpToDate(const std::string &output, const std::vector<std::string> &sources, uint32_t version);
+        bool IsUpToDate(const std::string &output, const std::string &source, uint32_t version);
+        /// The build is recorded by the first output. All of the outputs
+        /// must exist for the build to be up to date.
+        bool IsUpToDate(const std::vector<std::string> &outputs, const std::vector<std::string> &sources, uint32_t version);
+
+        void Record(const std::string &output, const std::vector<std::string> &sources, uint32_t version);
+        void Record(const std::string &output, const std::string &source, uint32_t version);
+
+    private:
+        struct Entry
+        {
+            uint64_t m_timeStamp;
+            uint64_t m_contentHash;
+            uint32_t m_version;
+            bool m_used;
+        };
+        std::map<std::string, Entry> m_entries;
+    };
+
+} // rob
+
+#endif // H_ROB_BUILD_DATABASE_H
@@ -0,0 +1,509 @@
+
+#include "FontBuilder.h"
+#include "Image.h"
+#include "../BmfFont.internal.h"
+#include "../FontFile.internal.h"
+#include "../ResourceID.h"
+#include "../../util/StreamUtil.h"
+#include "../../Log.h"
+#include "../../Types.h"
+
+#include <FreeImage.h>
+
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+namespace rob
+{
+
+    // Size of the generated atlas page in texels.
+    static const int SDF_ATLAS_SIZE = 256;
+    // The distance range encoded to the atlas in atlas texels.
+    static const int SDF_SPREAD = 4;
+    static const int SDF_MAX_DOWNSCALE = 8;
+
+    struct SourcePage
+    {
+        int m_width;
+        int m_height;
+        // One channel, rows from top to bottom.
+        std::vector<uint8_t> m_pixels;
+    };
+
+    struct SdfGlyph
+    {
+        BmfCharBlock m_char;
+        // Atlas page, position and size in the atlas
+        int m_page;
+        int m_x, m_y;
+        int m_width, m_height;
+    };
+
+    struct BmfFile
+    {
+        std::vector<char> m_infoBlock;
+        BmfCommonBlock m_common;
+        std::vector<std::string> m_pages;
+        std::vector<SdfGlyph> m_glyphs;
+        std::vector<char> m_kerningBlock;
+    };
+
+    static bool ReadBmf(const std::string &filename, BmfFile &bmf)
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        if (!in.is_open())
+        {
+            log::Error("FontBuilder: Could not open ", filename.c_str());
+            return false;
+        }
+
+        if (! (ReadValue<uint8_t>(in) == 'B'
+            && ReadValue<uint8_t>(in) == 'M'
+            && ReadValue<uint8_t>(in) == 'F'
+            && ReadValue<uint8_t>(in) == 3))
+        {
+            log::Error("FontBuilder: Invalid header or version in ", filename.c_str());
+            return false;
+        }
+
+        while (in)
+        {
+            const uint8_t block_type = ReadValue<uint8_t>(in);
+            if (in.eof()) break;
+            const uint32_t block_size = ReadValue<uint32_t>(in);
+
+            switch (block_type)
+            {
+            case BmfInfoBlock::TYPE:
+                bmf.m_infoBlock.resize(block_size);
+                in.read(bmf.m_infoBlock.data(), block_size);
+                break;
+
+            case BmfCommonBlock::TYPE:
+                bmf.m_common.line_height    = ReadValue<uint16_t>(in);
+                bmf.m_common.base           = ReadValue<uint16_t>(in);
+                bmf.m_common.scale_w        = ReadValue<uint16_t>(in);
+                bmf.m_common.scale_h        = ReadValue<uint16_t>(in);
+                bmf.m_common.pages          = ReadValue<uint16_t>(in);
+                bmf.m_common.bit_field      = ReadValue<uint8_t>(in);
+                bmf.m_common.alpha_channel  = ReadValue<uint8_t>(in);
+                bmf.m_common.red_channel    = ReadValue<uint8_t>(in);
+                bmf.m_common.green_channel  = ReadValue<uint8_t>(in);
+                bmf.m_common.blue_channel   = ReadValue<uint8_t>(in);
+                break;
+
+            case BmfPageBlock::TYPE:
+                {
+                    std::vector<char> names(block_size);
+                    in.read(names.data(), block_size);
+                    size_t_32 start = 0;
+                    for (size_t_32 i = 0; i < block_size; i++)
+                    {
+                        if (names[i] != '\0') continue;
+                        bmf.m_pages.push_back(std::string(&names[start], i - start));
+                        start = i + 1;
+                    }
+                }
+                break;
+
+            case BmfCharBlock::TYPE:
+                {
+                    const size_t_32 characterCount = block_size / 20;
+                    for (size_t_32 i = 0; i < characterCount; i++)
+                    {
+                        SdfGlyph glyph = { };
+                        BmfCharBlock &block = glyph.m_char;
+                        block.id        = ReadValue<uint32_t>(in);
+                        block.x         = ReadValue<uint16_t>(in);
+                        block.y         = ReadValue<uint16_t>(in);
+                        block.width     = ReadValue<uint16_t>(in);
+                        block.height    = ReadValue<uint16_t>(in);
+                        block.offset_x  = ReadValue<int16_t>(in);
+                        block.offset_y  = ReadValue<int16_t>(in);
+                        block.advance_x = ReadValue<uint16_t>(in);
+                        block.page      = ReadValue<uint8_t>(in);
+                        block.channel   = ReadValue<uint8_t>(in);
+                        bmf.m_glyphs.push_back(glyph);
+                    }
+                }
+                break;
+
+            case BmfKerningPairBlock::TYPE:
+                bmf.m_kerningBlock.resize(block_size);
+                in.read(bmf.m_kerningBlock.data(), block_size);
+                break;
+
+            default:
+                log::Error("FontBuilder: Invalid block type ", static_cast<unsigned int>(block_type),
+                           " in ", filename.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool LoadPage(const std::string &filename, bool useAlpha, SourcePage &page)
+    {
+        FREE_IMAGE_FORMAT format = ::FreeImage_GetFileType(filename.c_str(), 0);
+        if (format == FIF_UNKNOWN)
+            format = ::FreeImage_GetFIFFromFilename(filename.c_str());
+        FIBITMAP *bitmap = (format != FIF_UNKNOWN) ? ::FreeImage_Load(format, filename.c_str(), 0) : nullptr;
+        if (!bitmap)
+        {
+            log::Error("FontBuilder: Could not load font page ", filename.c_str());
+            return false;
+        }
+
+        FIBITMAP *bitmap32 = ::FreeImage_ConvertTo32Bits(bitmap);
+        ::FreeImage_Unload(bitmap);
+        if (!bitmap32)
+        {
+            log::Error("FontBuilder: Could not convert font page ", filename.c_str());
+            return false;
+        }
+
+        page.m_width = ::FreeImage_GetWidth(bitmap32);
+        page.m_height = ::FreeImage_GetHeight(bitmap32);
+        page.m_pixels.resize(page.m_width * page.m_height);
+
+        const int channel = useAlpha ? FI_RGBA_ALPHA : FI_RGBA_RED;
+        for (int y = 0; y < page.m_height; y++)
+        {
+            // FreeImage stores the scanlines from bottom to top.
+            const BYTE *bits = ::FreeImage_GetScanLine(bitmap32, page.m_height - 1 - y);
+            uint8_t *row = &page.m_pixels[y * page.m_width];
+            for (int x = 0; x < page.m_width; x++)
+                row[x] = bits[x * 4 + channel];
+        }
+
+        ::FreeImage_Unload(bitmap32);
+        return true;
+    }
+
+    static uint32_t GetBlock(const SdfGlyph &glyph)
+    { return glyph.m_char.id >> Font::GLYPH_BLOCK_BITS; }
+
+    /// Packs the glyphs to shelves, sized down by the given factor. The
+    /// glyphs are packed in code point order, so a block of characters ends
+    /// up to as few atlas pages as possible. Returns the number of pages
+    /// used, or 0 if the glyphs do not fit to the maximum number of pages.
+    static int PackGlyphs(std::vector<SdfGlyph> &glyphs, int downscale, int maxPages)
+    {
+        std::vector<SdfGlyph*> sorted;
+        for (SdfGlyph &glyph : glyphs)
+        {
+            glyph.m_width = (glyph.m_char.width + downscale - 1) / downscale;
+            glyph.m_height = (glyph.m_char.height + downscale - 1) / downscale;
+            glyph.m_page = 0;
+            glyph.m_x = glyph.m_y = 0;
+            if (glyph.m_width > 0 && glyph.m_height > 0)
+                sorted.push_back(&glyph);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const SdfGlyph *a, const SdfGlyph *b)
+        {
+            if (GetBlock(*a) != GetBlock(*b))
+                return GetBlock(*a) < GetBlock(*b);
+            return a->m_height > b->m_height;
+        });
+
+        // One texel gap between the glyphs for bilinear filtering.
+        int page = 0, x = 1, y = 1, shelfHeight = 0;
+        for (SdfGlyph *glyph : sorted)
+        {
+            if (x + glyph->m_width + 1 > SDF_ATLAS_SIZE)
+            {
+                x = 1;
+                y += shelfHeight + 1;
+                shelfHeight = 0;
+            }
+            if (y + glyph->m_height + 1 > SDF_ATLAS_SIZE)
+            {
+                if (++page >= maxPages)
+                    return 0;
+                x = y = 1;
+                shelfHeight = 0;
+            }
+            glyph->m_page = page;
+            glyph->m_x = x;
+            glyph->m_y = y;
+            x += glyph->m_width + 1;
+            shelfHeight = std::max(shelfHeight, glyph->m_height);
+        }
+        return page + 1;
+    }
+
+    static bool IsInside(const SourcePage &page, const BmfCharBlock &ch, int x, int y)
+    {
+        if (x < ch.x || x >= ch.x + ch.width || y < ch.y || y >= ch.y + ch.height)
+            return false;
+        if (x >= page.m_width || y >= page.m_height)
+            return false;
+        return page.m_pixels[y * page.m_width + x] >= 128;
+    }
+
+    static void RenderDistanceField(const SourcePage &page, const SdfGlyph &glyph, int downscale,
+                                    std::vector<uint8_t> &atlas)
+    {
+        const BmfCharBlock &ch = glyph.m_char;
+        const int radius = SDF_SPREAD * downscale;
+
+        for (int oy = 0; oy < glyph.m_height; oy++)
+        {
+            for (int ox = 0; ox < glyph.m_width; ox++)
+            {
+                const int cx = ch.x + ox * downscale + downscale / 2;
+                const int cy = ch.y + oy * downscale + downscale / 2;
+                const bool inside = IsInside(page, ch, cx, cy);
+
+                int minDistSq = radius * radius;
+                for (int dy = -radius; dy <= radius; dy++)
+                {
+                    for (int dx = -radius; dx <= radius; dx++)
+                    {
+                        const int distSq = dx * dx + dy * dy;
+                        if (distSq < minDistSq && IsInside(page, ch, cx + dx, cy + dy) != inside)
+                            minDistSq = distSq;
+                    }
+                }
+
+                const float dist = std::sqrt(float(minDistSq)) * (inside ? 1.0f : -1.0f);
+                float value = 0.5f + dist / (2.0f * radius);
+                value = std::min(std::max(value, 0.0f), 1.0f);
+                atlas[(glyph.m_y + oy) * SDF_ATLAS_SIZE + glyph.m_x + ox] = uint8_t(value * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    static std::string StripExtension(const std::string &filename)
+    {
+        const std::string::size_type dot = filename.find_last_of('.');
+        const std::string::size_type slash = filename.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            return filename;
+        return filename.substr(0, dot);
+    }
+
+    static std::string StripDirectory(const std::string &filename)
+    {
+        const std::string::size_type slash = filename.find_last_of("/\\");
+        return (slash == std::string::npos) ? filename : filename.substr(slash + 1);
+    }
+
+    static std::string GetDirectory(const std::string &filename)
+    {
+        const std::string::size_type slash = filename.find_last_of("/\\");
+        return (slash == std::string::npos) ? std::string() : filename.substr(0, slash + 1);
+    }
+
+    /// Returns the name of the distance field page without the extension.
+    static std::string GetAtlasName(const std::string &destFilename, size_t_32 page)
+    {
+        const std::string atlasStem = StripExtension(destFilename) + "_sdf";
+        return (page == 0) ? atlasStem : atlasStem + "_" + std::to_string(page);
+    }
+
+    static uint32_t AlignOffset(uint32_t offset)
+    { return (offset + FONT_FILE_DATA_ALIGN - 1) & ~(FONT_FILE_DATA_ALIGN - 1); }
+
+    template <class T>
+    static void WriteArray(std::ostream &out, uint32_t offset, const std::vector<T> &values)
+    {
+        while (uint32_t(out.tellp()) < offset)
+            out.put('\0');
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    static uint8_t GetSpacingVertical(const BmfFile &bmf)
+    {
+        // Offset of spacing_vertical in the info block.
+        const size_t_32 offset = 12;
+        return (bmf.m_infoBlock.size() > offset) ? uint8_t(bmf.m_infoBlock[offset]) : 0;
+    }
+
+    static bool WriteFont(const std::string &filename, const BmfFile &bmf,
+                          const std::vector<std::string> &pageNames, int downscale)
+    {
+        std::vector<const SdfGlyph*> glyphs;
+        for (const SdfGlyph &glyph : bmf.m_glyphs)
+        {
+            if (glyph.m_char.id > Font::MAX_CODE_POINT)
+            {
+                log::Warning("FontBuilder: Skipping character ", glyph.m_char.id, " in ", filename.c_str());
+                continue;
+            }
+            glyphs.push_back(&glyph);
+        }
+        std::sort(glyphs.begin(), glyphs.end(), [](const SdfGlyph *a, const SdfGlyph *b)
+        { return a->m_char.id < b->m_char.id; });
+
+        const uint32_t directorySize = glyphs.empty() ? 0 : GetBlock(*glyphs.back()) + 1;
+        std::vector<uint16_t> directory(directorySize, uint16_t(Font::NO_GLYPH_BLOCK));
+        std::vector<Glyph> blocks;
+        std::vector<uint32_t> characters;
+        for (const SdfGlyph *glyph : glyphs)
+        {
+            const BmfCharBlock &ch = glyph->m_char;
+            uint16_t &blockIndex = directory[GetBlock(*glyph)];
+            if (blockIndex == Font::NO_GLYPH_BLOCK)
+            {
+                Glyph missing = { };
+                missing.m_textureIdx = Font::NO_GLYPH;
+                blockIndex = blocks.size() / Font::GLYPH_BLOCK_SIZE;
+                blocks.resize(blocks.size() + Font::GLYPH_BLOCK_SIZE, missing);
+            }
+
+            // The glyph coordinates are kept in the source resolution and the
+            // texture size tells the resolution they are relative to.
+            Glyph &g = blocks[(blockIndex << Font::GLYPH_BLOCK_BITS) | (ch.id & (Font::GLYPH_BLOCK_SIZE - 1))];
+            g.m_x       = glyph->m_x * downscale;
+            g.m_y       = glyph->m_y * downscale;
+            g.m_width   = glyph->m_width * downscale;
+            g.m_height  = glyph->m_height * downscale;
+            g.m_offsetX = ch.offset_x;
+            g.m_offsetY = ch.offset_y;
+            g.m_advance = ch.advance_x;
+            g.m_textureIdx = glyph->m_page;
+            characters.push_back(ch.id);
+        }
+
+        std::vector<uint32_t> pageIds;
+        for (const std::string &pageName : pageNames)
+            pageIds.push_back(ResourceID(pageName.c_str()));
+
+        FontFileHeader header;
+        header.magic = FontFileHeader::MAGIC;
+        header.version = FontFileHeader::VERSION;
+        header.line_height = bmf.m_common.line_height;
+        header.base = bmf.m_common.base;
+        header.horizontal_spacing = 0;
+        header.line_spacing = GetSpacingVertical(bmf);
+        header.texture_width = SDF_ATLAS_SIZE * downscale;
+        header.texture_height = SDF_ATLAS_SIZE * downscale;
+        header.page_count = pageIds.size();
+        header.glyph_count = characters.size();
+        header.directory_size = directorySize;
+        header.block_count = blocks.size() / Font::GLYPH_BLOCK_SIZE;
+        header.pages_offset = AlignOffset(sizeof(header));
+        header.characters_offset = AlignOffset(header.pages_offset + header.page_count * sizeof(uint32_t));
+        header.directory_offset = AlignOffset(header.characters_offset + header.glyph_count * sizeof(uint32_t));
+        header.blocks_offset = AlignOffset(header.directory_offset + header.directory_size * sizeof(uint16_t));
+
+        std::ofstream out(filename.c_str(), std::ios_base::binary);
+        if (!out.is_open())
+        {
+            log::Error("FontBuilder: Could not open the destination file ", filename.c_str());
+            return false;
+        }
+
+        WriteValue(out, header);
+        WriteArray(out, header.pages_offset, pageIds);
+        WriteArray(out, header.characters_offset, characters);
+        WriteArray(out, header.directory_offset, directory);
+        WriteArray(out, header.blocks_offset, blocks);
+        return bool(out);
+    }
+
+    FontBuilder::FontBuilder()
+    {
+        m_extensions.push_back(".fnt");
+        m_version = 4;
+    }
+
+    void FontBuilder::GetDependencies(const std::string &filename, const std::string &destFilename,
+                                      std::vector<std::string> &sources, std::vector<std::string> &outputs) const
+    {
+        sources.push_back(filename);
+        outputs.push_back(destFilename);
+
+        BmfFile bmf;
+        if (ReadBmf(filename, bmf))
+        {
+            const std::string sourceDir = GetDirectory(filename);
+            for (const std::string &page : bmf.m_pages)
+                sources.push_back(sourceDir + page);
+        }
+
+        // The number of distance field pages is known only after building,
+        // so it is read from the previously built font.
+        std::ifstream in(destFilename.c_str(), std::ios::binary);
+        FontFileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return;
+        if (header.magic != FontFileHeader::MAGIC || header.version != FontFileHeader::VERSION)
+            return;
+        for (uint32_t i = 0; i < header.page_count; i++)
+            outputs.push_back(GetAtlasName(destFilename, i) + ".tex");
+    }
+
+    bool FontBuilder::Build(const std::string &directory, const std::string &filename,
+                            const std::string &destDirectory, const std::string &destFilename)
+    {
+        BmfFile bmf;
+        if (!ReadBmf(filename, bmf))
+            return false;
+
+        // Glyph data is in the alpha channel, if the alpha channel holds
+        // the glyph (0) or the glyph and the outline (2).
+        const bool useAlpha = (bmf.m_common.alpha_channel == 0 || bmf.m_common.alpha_channel == 2);
+
+        const std::string sourceDir = GetDirectory(filename);
+        std::vector<SourcePage> pages(bmf.m_pages.size());
+        for (size_t_32 i = 0; i < pages.size(); i++)
+        {
+            if (!LoadPage(sourceDir + bmf.m_pages[i], useAlpha, pages[i]))
+                return false;
+        }
+
+        // Prefer a single page with the best resolution, and fall back to
+        // multiple pages for large character sets.
+        int downscale = 1;
+        int atlasPageCount = 0;
+        for (; downscale <= SDF_MAX_DOWNSCALE && !atlasPageCount; downscale++)
+            atlasPageCount = PackGlyphs(bmf.m_glyphs, downscale, 1);
+        downscale--;
+        if (!atlasPageCount)
+            atlasPageCount = PackGlyphs(bmf.m_glyphs, downscale, Font::MAX_TEXTURE_PAGES);
+        if (!atlasPageCount)
+        {
+            log::Error("FontBuilder: Glyphs of ", filename.c_str(), " do not fit to ",
+                       size_t_32(Font::MAX_TEXTURE_PAGES), " ", SDF_ATLAS_SIZE, "x", SDF_ATLAS_SIZE, " atlas pages");
+            return false;
+        }
+
+        std::vector<Image> atlases(atlasPageCount);
+        for (Image &atlas : atlases)
+        {
+            atlas.m_width = SDF_ATLAS_SIZE;
+            atlas.m_height = SDF_ATLAS_SIZE;
+            atlas.m_format = Texture::FMT_LUMINANCE;
+            atlas.m_pixels.resize(SDF_ATLAS_SIZE * SDF_ATLAS_SIZE, 0);
+        }
+        for (const SdfGlyph &glyph : bmf.m_glyphs)
+        {
+            if (glyph.m_char.page >= pages.size())
+            {
+                log::Error("FontBuilder: Invalid page ", static_cast<unsigned int>(glyph.m_char.page),
+                           " for character ", glyph.m_char.id, " in ", filename.c_str());
+                return false;
+            }
+            RenderDistanceField(pages[glyph.m_char.page], glyph, downscale, atlases[glyph.m_page].m_pixels);
+        }
+
+        std::vector<std::string> pageNames;
+        for (int i = 0; i < atlasPageCount; i++)
+        {
+            const std::string atlasName = GetAtlasName(destFilename, i);
+            if (!WriteTexture(atlasName + ".tex", atlases[i]))
+                return false;
+            pageNames.push_back(StripDirectory(atlasName) + ".tex");
+        }
+        if (!WriteFont(destFilename, bmf, pageNames, downscale))
+            return false;
+
+        log::Info("FontBuilder: ", bmf.m_pages.size(), " pages to ", atlasPageCount, " ",
+                  SDF_ATLAS_SIZE, "x", SDF_ATLAS_SIZE, " distance field pages, downscale ", downscale);
+        return true;
+    }
+
+} // rob
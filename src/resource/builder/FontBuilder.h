@@ -0,0 +1,28 @@
+
+#ifndef H_ROB_FONT_BUILDER_H
+#define H_ROB_FONT_BUILDER_H
+
+#include "ResourceBuilder.h"
+
+namespace rob
+{
+
+    /// Builds a BMFont binary font into a font with a single page signed
+    /// distance field atlas. The glyphs of all source pages are converted to
+    /// distance fields, downscaled and packed to one small texture. The font
+    /// is written in the format of FontFile.internal.h.
+    class FontBuilder : public ResourceBuilder
+    {
+    public:
+        FontBuilder();
+        /// The font depends also on its page images, and writes the
+        /// distance field pages listed in the built font.
+        void GetDependencies(const std::string &filename, const std::string &destFilename,
+                             std::vector<std::string> &sources, std::vector<std::string> &outputs) const override;
+        bool Build(const std::string &directory, const std::string &filename,
+                   const std::string &destDirectory, const std::string &destFilename) override;
+    };
+
+} // rob
+
+#endif // H_ROB_FONT_BUILDER_H
@@ -0,0 +1,285 @@
+
+#include "Image.h"
+#include "../TextureFile.internal.h"
+#include "../../filesystem/MappedFile.h"
+#include "../../time/MicroTicker.h"
+#include "../../util/Lz4.h"
+#include "../../util/StreamUtil.h"
+#include "../../Log.h"
+
+#include <FreeImage.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+
+namespace rob
+{
+
+    static void SwizzleToRgb(const uint8_t *src, uint8_t *dest, size_t_32 count)
+    {
+        for (size_t_32 i = 0; i < count; i++)
+        {
+            dest[0] = src[FI_RGBA_RED];
+            dest[1] = src[FI_RGBA_GREEN];
+            dest[2] = src[FI_RGBA_BLUE];
+            src += 3;
+            dest += 3;
+        }
+    }
+
+    static void SwizzleToRgba(const uint8_t *src, uint8_t *dest, size_t_32 count)
+    {
+    #if FI_RGBA_RED == 2 && FI_RGBA_GREEN == 1 && FI_RGBA_BLUE == 0 && FI_RGBA_ALPHA == 3 && defined(__SSE2__)
+        // Swaps the red and blue bytes of four BGRA pixels at a time. The
+        // green and alpha bytes stay in place.
+        const __m128i keepMask = _mm_set1_epi32(0xff00ff00);
+        const __m128i lowMask = _mm_set1_epi32(0x000000ff);
+        size_t_32 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128i ga = _mm_and_si128(bgra, keepMask);
+            const __m128i r = _mm_and_si128(_mm_srli_epi32(bgra, 16), lowMask);
+            const __m128i b = _mm_slli_epi32(_mm_and_si128(bgra, lowMask), 16);
+            const __m128i rgba = _mm_or_si128(ga, _mm_or_si128(r, b));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), rgba);
+            src += 16;
+            dest += 16;
+        }
+        count -= i;
+    #endif
+        for (size_t_32 i = 0; i < count; i++)
+        {
+            dest[0] = src[FI_RGBA_RED];
+            dest[1] = src[FI_RGBA_GREEN];
+            dest[2] = src[FI_RGBA_BLUE];
+            dest[3] = src[FI_RGBA_ALPHA];
+            src += 4;
+            dest += 4;
+        }
+    }
+
+    bool LoadImage(const std::string &filename, Image &image)
+    {
+        FREE_IMAGE_FORMAT format = ::FreeImage_GetFileType(filename.c_str(), 0);
+        if (format == FIF_UNKNOWN)
+        {
+            format = ::FreeImage_GetFIFFromFilename(filename.c_str());
+            if (format == FIF_UNKNOWN)
+            {
+                log::Error("Could not determine image file type for ", filename.c_str());
+                return false;
+            }
+        }
+        FIBITMAP *bitmap = ::FreeImage_Load(format, filename.c_str(), 0);
+
+        if (!bitmap)
+        {
+            log::Error("Could not load image ", filename.c_str());
+            return false;
+        }
+
+        if (::FreeImage_GetImageType(bitmap) != FIT_BITMAP)
+        {
+            log::Error("Invalid image type in ", filename.c_str());
+            ::FreeImage_Unload(bitmap);
+            return false;
+        }
+
+        const FREE_IMAGE_COLOR_TYPE colorType = ::FreeImage_GetColorType(bitmap);
+        const size_t_32 bpp = ::FreeImage_GetBPP(bitmap);
+        switch (colorType)
+        {
+        case FIC_RGB:
+            // For some reason rgba-png has color type FIC_RGB with bpp=32.
+            if (bpp == 32)
+                image.m_format = Texture::FMT_RGBA;
+            else
+                image.m_format = Texture::FMT_RGB;
+            break;
+        case FIC_RGBALPHA:
+            image.m_format = Texture::FMT_RGBA;
+            break;
+        default:
+            log::Error("Unsupported image color type in image ", filename.c_str());
+            ::FreeImage_Unload(bitmap);
+            return false;
+        }
+
+        image.m_width = ::FreeImage_GetWidth(bitmap);
+        image.m_height = ::FreeImage_GetHeight(bitmap);
+        const size_t_32 bytesPerPixel = image.GetBytesPerPixel();
+        image.m_pixels.resize(image.m_width * image.m_height * bytesPerPixel);
+
+        uint8_t *data = image.m_pixels.data();
+        const size_t_32 rowSize = image.m_width * bytesPerPixel;
+        for (size_t_32 y = 0; y < image.m_height; y++)
+        {
+            // FreeImage stores the scanlines from bottom to top.
+            const BYTE *bits = ::FreeImage_GetScanLine(bitmap, image.m_height - 1 - y);
+            if (bytesPerPixel == 4)
+                SwizzleToRgba(bits, data, image.m_width);
+            else
+                SwizzleToRgb(bits, data, image.m_width);
+            data += rowSize;
+        }
+
+        ::FreeImage_Unload(bitmap);
+        return true;
+    }
+
+    static void DownsampleImage(const Image &src, Image &dest)
+    {
+        const size_t_32 bpp = src.GetBytesPerPixel();
+        dest.m_width = (src.m_width > 1) ? src.m_width / 2 : 1;
+        dest.m_height = (src.m_height > 1) ? src.m_height / 2 : 1;
+        dest.m_format = src.m_format;
+        dest.m_pixels.resize(dest.m_width * dest.m_height * bpp);
+
+        for (size_t_32 y = 0; y < dest.m_height; y++)
+        {
+            const size_t_32 y0 = y * 2;
+            const size_t_32 y1 = (y0 + 1 < src.m_height) ? y0 + 1 : y0;
+            for (size_t_32 x = 0; x < dest.m_width; x++)
+            {
+                const size_t_32 x0 = x * 2;
+                const size_t_32 x1 = (x0 + 1 < src.m_width) ? x0 + 1 : x0;
+                const uint8_t *p00 = &src.m_pixels[(y0 * src.m_width + x0) * bpp];
+                const uint8_t *p01 = &src.m_pixels[(y0 * src.m_width + x1) * bpp];
+                const uint8_t *p10 = &src.m_pixels[(y1 * src.m_width + x0) * bpp];
+                const uint8_t *p11 = &src.m_pixels[(y1 * src.m_width + x1) * bpp];
+                uint8_t *d = &dest.m_pixels[(y * dest.m_width + x) * bpp];
+                for (size_t_32 c = 0; c < bpp; c++)
+                    d[c] = uint8_t((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+            }
+        }
+    }
+
+    /// Measures the time to map the texture file and decode the mip levels.
+    static Time_t MeasureLoadTime(const std::string &filename)
+    {
+        MicroTicker ticker;
+        ticker.Init();
+        const Time_t start = ticker.GetTicks();
+
+        MappedFile file;
+        if (!file.Open(filename.c_str()))
+            return 0;
+
+        TextureFileHeader header;
+        std::memcpy(&header, file.GetData(), sizeof(header));
+        const TextureFileMip *mips = reinterpret_cast<const TextureFileMip*>(file.GetData() + sizeof(header));
+
+        std::vector<uint8_t> buffer;
+        for (uint32_t i = 0; i < header.mip_count; i++)
+        {
+            if (mips[i].stored_size == mips[i].size)
+                continue;
+            buffer.resize(mips[i].size);
+            Lz4Decompress(file.GetData() + mips[i].offset, mips[i].stored_size, buffer.data(), mips[i].size);
+        }
+        return ticker.GetTicks() - start;
+    }
+
+    bool WriteTexture(const std::string &filename, const Image &image, const TextureOptions &options)
+    {
+        std::vector<Image> mips(1, image);
+        if (options.m_mipmaps)
+        {
+            while (mips.size() < TEXTURE_FILE_MAX_MIPS
+                && (mips.back().m_width > 1 || mips.back().m_height > 1))
+            {
+                Image mip;
+                DownsampleImage(mips.back(), mip);
+                mips.push_back(mip);
+            }
+        }
+
+        // The texture rows are stored from bottom to top.
+        std::vector<std::vector<uint8_t>> data(mips.size());
+        for (size_t_32 i = 0; i < mips.size(); i++)
+        {
+            const Image &mip = mips[i];
+            const size_t_32 rowSize = mip.m_width * mip.GetBytesPerPixel();
+            data[i].resize(rowSize * mip.m_height);
+            for (size_t_32 y = 0; y < mip.m_height; y++)
+            {
+                std::memcpy(&data[i][y * rowSize],
+                            &mip.m_pixels[(mip.m_height - 1 - y) * rowSize], rowSize);
+            }
+        }
+
+        std::vector<TextureFileMip> mipInfo(mips.size());
+        std::vector<std::vector<uint8_t>> stored(mips.size());
+        size_t_32 rawSize = 0;
+        uint32_t offset = sizeof(TextureFileHeader) + mips.size() * sizeof(TextureFileMip);
+        for (size_t_32 i = 0; i < mips.size(); i++)
+        {
+            const size_t_32 size = data[i].size();
+            rawSize += size;
+
+            stored[i].swap(data[i]);
+            if (options.m_compress)
+            {
+                std::vector<uint8_t> compressed(Lz4CompressBound(size));
+                const size_t_32 compressedSize = Lz4Compress(stored[i].data(), size,
+                                                             compressed.data(), compressed.size());
+                if (compressedSize > 0 && compressedSize < size)
+                {
+                    compressed.resize(compressedSize);
+                    stored[i].swap(compressed);
+                }
+            }
+
+            offset = (offset + TEXTURE_FILE_DATA_ALIGN - 1) & ~(TEXTURE_FILE_DATA_ALIGN - 1);
+            mipInfo[i].offset = offset;
+            mipInfo[i].stored_size = stored[i].size();
+            mipInfo[i].size = size;
+            offset += stored[i].size();
+        }
+
+        {
+            std::ofstream out(filename.c_str(), std::ios_base::binary);
+            if (!out.is_open())
+            {
+                log::Error("Could not open the destination file for image ", filename.c_str());
+                return false;
+            }
+
+            TextureFileHeader header;
+            header.magic = TextureFileHeader::MAGIC;
+            header.version = TextureFileHeader::VERSION;
+            header.width = image.m_width;
+            header.height = image.m_height;
+            header.format = static_cast<uint32_t>(image.m_format);
+            header.mip_count = mips.size();
+            header.flags = 0;
+            WriteValue(out, header);
+            for (const TextureFileMip &mip : mipInfo)
+                WriteValue(out, mip);
+
+            for (size_t_32 i = 0; i < mips.size(); i++)
+            {
+                while (size_t_32(out.tellp()) < mipInfo[i].offset)
+                    out.put(0);
+                out.write(reinterpret_cast<const char*>(stored[i].data()), stored[i].size());
+            }
+
+            if (!out)
+            {
+                log::Error("Could not write texture ", filename.c_str());
+                return false;
+            }
+        }
+
+        log::Info("Texture ", filename.c_str(), ": ", image.m_width, "x", image.m_height,
+                  ", ", mips.size(), " mips, ", rawSize, " B raw, ", offset, " B on disk, ",
+                  MeasureLoadTime(filename), " us to load");
+        return true;
+    }
+
+} // rob
@@ -0,0 +1,47 @@
+
+#ifndef H_ROB_BUILDER_IMAGE_H
+#define H_ROB_BUILDER_IMAGE_H
+
+#include "../../graphics/Texture.h"
+#include "../../Types.h"
+
+#include <string>
+#include <vector>
+
+namespace rob
+{
+
+    /// Image data used by the builders. The rows are stored from top to bottom.
+    struct Image
+    {
+        size_t_32 m_width;
+        size_t_32 m_height;
+        Texture::Format m_format;
+        std::vector<uint8_t> m_pixels;
+
+        size_t_32 GetBytesPerPixel() const
+        { return static_cast<size_t_32>(m_format); }
+    };
+
+    struct TextureOptions
+    {
+        TextureOptions()
+            : m_mipmaps(true)
+            , m_compress(true)
+        { }
+
+        /// Generate the mip chain with box filtering.
+        bool m_mipmaps;
+        /// Compress the mip levels with LZ4, if it makes them smaller.
+        bool m_compress;
+    };
+
+    bool LoadImage(const std::string &filename, Image &image);
+
+    /// Writes the image in the .tex format read by TextureCache.
+    bool WriteTexture(const std::string &filename, const Image &image,
+                      const TextureOptions &options = TextureOptions());
+
+} // rob
+
+#endif // H_ROB_BUILDER_IMAGE_H
@@ -4,32 +4,199 @@
 #include "../../Log.h"
 
 #include "TextureBuilder.h"
+#include "FontBuilder.h"
+#include "SoundBuilder.h"
 #include "ResourceCopier.h"
+#include "AtlasBuilder.h"
+#include "PakBuilder.h"
+#include "BuildDatabase.h"
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_thread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
 
 namespace rob
 {
 
     TextureBuilder  g_textureBuilder;
+    FontBuilder     g_fontBuilder;
+    SoundBuilder    g_soundBuilder;
     ResourceCopier  g_resourceCopier;
 
+    /// Output that needs to be built from the sources.
+    struct BuildJob
+    {
+        std::string m_output;
+        std::vector<std::string> m_sources;
+        uint32_t m_version;
+        std::function<bool ()> m_build;
+        bool m_result;
+    };
+
+    struct BuildJobQueue
+    {
+        std::vector<BuildJob> *m_jobs;
+        std::atomic<size_t_32> m_next;
+    };
+
+    static int BuildWorker(void *data)
+    {
+        BuildJobQueue *queue = static_cast<BuildJobQueue*>(data);
+        std::vector<BuildJob> &jobs = *queue->m_jobs;
+        for (size_t_32 i = queue->m_next++; i < jobs.size(); i = queue->m_next++)
+            jobs[i].m_result = jobs[i].m_build();
+        return 0;
+    }
+
+    /// Builds the jobs on all cores. The calling thread builds as well.
+    static void RunBuildJobs(std::vector<BuildJob> &jobs)
+    {
+        BuildJobQueue queue;
+        queue.m_jobs = &jobs;
+        queue.m_next = 0;
+
+        const int cpuCount = ::SDL_GetCPUCount();
+        const size_t_32 threadCount = std::min<size_t_32>(cpuCount > 1 ? cpuCount - 1 : 0, jobs.size());
+        std::vector<SDL_Thread*> threads;
+        for (size_t_32 i = 0; i < threadCount; i++)
+        {
+            SDL_Thread *thread = ::SDL_CreateThread(&BuildWorker, "BuildWorker", &queue);
+            if (thread) threads.push_back(thread);
+        }
+
+        BuildWorker(&queue);
+        for (SDL_Thread *thread : threads)
+            ::SDL_WaitThread(thread, nullptr);
+    }
+
     void MasterBuilder::Build(const char * const source, const char * const dest)
     {
+        const std::string databaseFile = std::string(dest) + ".builddb";
+        BuildDatabase database;
+        database.Load(databaseFile);
+        BuildReport report = { };
+
         std::vector<std::string> files;
-        GetFilesFromDirectory(source, files, true);
+        GetFilesFromDirectory(std::string(source) + "/", files, true);
+
+        std::map<std::string, std::vector<std::string>> atlases;
+        std::vector<BuildJob> jobs;
 
         for (const std::string &file : files)
         {
+            std::string atlasName;
+            if (AtlasBuilder::IsAtlasImage(file, atlasName))
+            {
+                atlases[atlasName].push_back(file);
+                continue;
+            }
+
             const std::string sourceFile = std::string(source) + "/" + file;
             const std::string destFile = std::string(dest) + "/" + file;
 
             ResourceBuilder *builder = ResourceBuilder::m_tail;
-            while (builder)
-            {
-                if (builder->TryBuild(source, sourceFile, dest, destFile))
-                    break;
+            std::string output;
+            while (builder && !builder->GetOutputFilename(sourceFile, destFile, output))
                 builder = builder->m_next;
+            if (!builder)
+                continue;
+
+            std::vector<std::string> sources, outputs;
+            builder->GetDependencies(sourceFile, output, sources, outputs);
+            if (database.IsUpToDate(outputs, sources, builder->GetVersion()))
+            {
+                report.m_skipped++;
+                continue;
             }
+
+            BuildJob job;
+            job.m_output = output;
+            job.m_sources = sources;
+            job.m_version = builder->GetVersion();
+            job.m_build = [=]()
+            {
+                if (!builder->Build(source, sourceFile, dest, output))
+                    return false;
+                log::Info("Built ", sourceFile.c_str(), " to ", output.c_str());
+                return true;
+            };
+            job.m_result = false;
+            jobs.push_back(job);
         }
+
+        for (const auto &atlas : atlases)
+        {
+            const std::string tableFile = std::string(dest) + "/" + AtlasBuilder::GetTableName(atlas.first);
+            std::vector<std::string> sourceFiles;
+            for (const std::string &file : atlas.second)
+                sourceFiles.push_back(std::string(source) + "/" + file);
+
+            if (database.IsUpToDate(tableFile, sourceFiles, AtlasBuilder::VERSION))
+            {
+                report.m_skipped++;
+                continue;
+            }
+
+            BuildJob job;
+            job.m_output = tableFile;
+            job.m_sources = sourceFiles;
+            job.m_version = AtlasBuilder::VERSION;
+            job.m_build = [=]()
+            {
+                AtlasBuilder atlasBuilder;
+                return atlasBuilder.Build(atlas.first, atlas.second, source, dest);
+            };
+            job.m_result = false;
+            jobs.push_back(job);
+        }
+
+        RunBuildJobs(jobs);
+
+        for (const BuildJob &job : jobs)
+        {
+            if (job.m_result)
+            {
+                database.Record(job.m_output, job.m_sources, job.m_version);
+                report.m_built++;
+            }
+            else
+            {
+                log::Error("Could not build ", job.m_output.c_str());
+                report.m_failed++;
+            }
+        }
+
+        // The archive depends on every built file, which are compared by
+        // their modification times.
+        std::vector<std::string> builtFiles;
+        GetFilesFromDirectory(std::string(dest) + "/", builtFiles, true);
+        for (std::string &file : builtFiles)
+            file = std::string(dest) + "/" + file;
+
+        PakBuilder pakBuilder;
+        const std::string pakFile = std::string(dest) + ".pak";
+        if (database.IsUpToDate(pakFile, builtFiles, PakBuilder::VERSION))
+        {
+            report.m_skipped++;
+        }
+        else if (pakBuilder.Build(dest, pakFile.c_str()))
+        {
+            database.Record(pakFile, builtFiles, PakBuilder::VERSION);
+            report.m_built++;
+        }
+        else
+        {
+            log::Error("Could not build resource archive ", pakFile.c_str());
+            report.m_failed++;
+        }
+
+        database.Save(databaseFile);
+        log::Info("Resources: ", report.m_built, " built, ", report.m_skipped, " up to date, ",
+                  report.m_failed, " failed");
     }
 
 } // rob
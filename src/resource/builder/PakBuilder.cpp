@@ -0,0 +1,121 @@
+
+#include "PakBuilder.h"
+#include "../PakFile.internal.h"
+#include "../ResourceID.h"
+#include "../../filesystem/FilesFromDirectory.h"
+#include "../../util/StreamUtil.h"
+#include "../../Log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace rob
+{
+
+    struct PakSource
+    {
+        uint32_t m_id;
+        std::string m_name;
+    };
+
+    static uint32_t AlignOffset(uint32_t offset)
+    { return (offset + PAK_FILE_DATA_ALIGN - 1) & ~(PAK_FILE_DATA_ALIGN - 1); }
+
+    static void WritePadding(std::ostream &out, uint32_t from, uint32_t to)
+    {
+        for (; from < to; from++)
+            out.put('\0');
+    }
+
+    bool PakBuilder::Build(const char * const directory, const char * const pakFile)
+    {
+        const std::string dir = std::string(directory) + "/";
+        std::vector<std::string> files;
+        GetFilesFromDirectory(dir, files, true);
+
+        std::vector<PakSource> sources;
+        sources.reserve(files.size());
+        for (const std::string &file : files)
+            sources.push_back(PakSource{ ResourceID(file.c_str()), file });
+
+        std::sort(sources.begin(), sources.end(),
+            [](const PakSource &a, const PakSource &b) { return a.m_id < b.m_id; });
+
+        for (size_t_32 i = 1; i < sources.size(); i++)
+        {
+            if (sources[i - 1].m_id == sources[i].m_id)
+            {
+                log::Error("PakBuilder: Resource id collision: ", sources[i - 1].m_name.c_str(),
+                           " and ", sources[i].m_name.c_str());
+                return false;
+            }
+        }
+
+        std::vector<PakFileEntry> entries(sources.size());
+        uint32_t namesSize = 0;
+        for (size_t_32 i = 0; i < sources.size(); i++)
+        {
+            entries[i].id = sources[i].m_id;
+            entries[i].name_offset = namesSize;
+            namesSize += sources[i].m_name.length() + 1;
+        }
+
+        std::ofstream out(pakFile, std::ios::binary);
+        if (!out.is_open())
+        {
+            log::Error("PakBuilder: Could not open ", pakFile, " for writing");
+            return false;
+        }
+
+        PakFileHeader header;
+        header.magic = PakFileHeader::MAGIC;
+        header.version = PakFileHeader::VERSION;
+        header.entry_count = entries.size();
+        header.names_size = namesSize;
+
+        // The table of contents is written after the data offsets are known.
+        const uint32_t namesOffset = sizeof(header) + entries.size() * sizeof(PakFileEntry);
+        uint32_t offset = AlignOffset(namesOffset + namesSize);
+        out.seekp(namesOffset);
+        for (const PakSource &source : sources)
+            out.write(source.m_name.c_str(), source.m_name.length() + 1);
+        WritePadding(out, namesOffset + namesSize, offset);
+
+        for (size_t_32 i = 0; i < sources.size(); i++)
+        {
+            const std::string filename = dir + sources[i].m_name;
+            std::ifstream in(filename.c_str(), std::ios::binary);
+            if (!in.is_open())
+            {
+                log::Error("PakBuilder: Could not open ", filename.c_str());
+                return false;
+            }
+            const std::vector<char> data((std::istreambuf_iterator<char>(in)),
+                                         std::istreambuf_iterator<char>());
+
+            entries[i].offset = offset;
+            entries[i].size = data.size();
+            out.write(data.data(), data.size());
+
+            const uint32_t end = offset + data.size();
+            offset = AlignOffset(end);
+            WritePadding(out, end, offset);
+        }
+
+        out.seekp(0);
+        WriteValue(out, header);
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PakFileEntry));
+
+        if (!out)
+        {
+            log::Error("PakBuilder: Could not write ", pakFile);
+            return false;
+        }
+
+        log::Info("PakBuilder: Packed ", uint32_t(entries.size()), " resources to ", pakFile,
+                  " (", offset, " bytes)");
+        return true;
+    }
+
+} // rob
@@ -0,0 +1,22 @@
+
+#ifndef H_ROB_PAK_BUILDER_H
+#define H_ROB_PAK_BUILDER_H
+
+#include "../../Types.h"
+
+namespace rob
+{
+
+    /// Packs all files of a directory to a single .pak archive. The files are
+    /// identified by the resource id of their path relative to the directory.
+    class PakBuilder
+    {
+    public:
+        static const uint32_t VERSION = 1;
+
+        bool Build(const char * const directory, const char * const pakFile);
+    };
+
+} // rob
+
+#endif // H_ROB_PAK_BUILDER_H
@@ -1,7 +1,5 @@
 
 #include "ResourceBuilder.h"
-#include "../../filesystem/FileStat.h"
-#include "../../Log.h"
 #include "../../Types.h"
 
 namespace rob
@@ -13,6 +11,7 @@ namespace rob
     ResourceBuilder::ResourceBuilder()
         : m_extensions()
         , m_newExtension()
+        , m_version(1)
         , m_next(nullptr)
     {
         if (m_head)
@@ -27,8 +26,8 @@ namespace rob
         }
     }
 
-    bool ResourceBuilder::TryBuild(const std::string &directory, const std::string &filename,
-                                   const std::string &destDirectory, const std::string &destFilename)
+    bool ResourceBuilder::GetOutputFilename(const std::string &filename, const std::string &destFilename,
+                                            std::string &output) const
     {
         for (size_t_32 i = 0; i < m_extensions.size(); i++)
         {
@@ -42,24 +41,11 @@ namespace rob
             const size_t_32 pos = fnlen - extlen;
             if (filename.compare(pos, extlen, ext) == 0)
             {
-                std::string newFilename = destFilename;
+                output = destFilename;
                 if (!m_newExtension.empty())
                 {
-                    const size_t_32 pos = destFilename.length() - extlen;
-                    newFilename.resize(pos);
-                    newFilename += m_newExtension;
-                }
-                if (!FileExists(newFilename.c_str()) ||
-                    GetModifyTime(newFilename.c_str()) < GetModifyTime(filename.c_str()))
-                {
-                    if (Build(directory, filename, destDirectory, newFilename))
-                    {
-                        log::Info("Built ", filename.c_str(), " to ", newFilename.c_str());
-                    }
-                    else
-                    {
-                        log::Error("Could not build ", filename.c_str(), " to ", newFilename.c_str());
-                    }
+                    output.resize(destFilename.length() - extlen);
+                    output += m_newExtension;
                 }
                 return true;
             }
@@ -67,4 +53,11 @@ namespace rob
         return false;
     }
 
+    void ResourceBuilder::GetDependencies(const std::string &filename, const std::string &destFilename,
+                                          std::vector<std::string> &sources, std::vector<std::string> &outputs) const
+    {
+        sources.push_back(filename);
+        outputs.push_back(destFilename);
+    }
+
 } // rob
@@ -2,6 +2,8 @@
 #ifndef H_ROB_RESOURCE_BUILDER_H
 #define H_ROB_RESOURCE_BUILDER_H
 
+#include "../../Types.h"
+
 #include <string>
 #include <vector>
 
@@ -16,14 +18,29 @@ namespace rob
         ResourceBuilder& operator = (const ResourceBuilder&) = delete;
         virtual ~ResourceBuilder() { }
 
-        bool TryBuild(const std::string &directory, const std::string &filename,
-                      const std::string &destDirectory, const std::string &destFilename);
+        /// Returns true, if the file is built by this builder and sets the
+        /// name of the output file.
+        bool GetOutputFilename(const std::string &filename, const std::string &destFilename,
+                               std::string &output) const;
+        uint32_t GetVersion() const { return m_version; }
+
+        /// Gets the files read and written by building the file. The first
+        /// output is \c destFilename. By default the build reads only the
+        /// file and writes only the output.
+        virtual void GetDependencies(const std::string &filename, const std::string &destFilename,
+                                     std::vector<std::string> &sources, std::vector<std::string> &outputs) const;
+
+        /// Builds the file to the output. Called concurrently for different
+        /// files, so the builders must not modify shared state.
         virtual bool Build(const std::string &directory, const std::string &filename,
                            const std::string &destDirectory, const std::string &destFilename) = 0;
 
     protected:
         std::vector<std::string> m_extensions;
         std::string m_newExtension;
+        /// Increment, when the output of the builder changes, so that the
+        /// outputs built by an older version are rebuilt.
+        uint32_t m_version;
         ResourceBuilder *m_next;
 
         friend class MasterBuilder;
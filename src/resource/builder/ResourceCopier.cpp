@@ -8,8 +8,6 @@ namespace rob
     ResourceCopier::ResourceCopier()
     {
         m_extensions.push_back(".ion");
-        m_extensions.push_back(".wav");
-        m_extensions.push_back(".fnt");
     }
 
     bool ResourceCopier::Build(const std::string &directory, const std::string &filename,
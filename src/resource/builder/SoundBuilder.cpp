@@ -0,0 +1,93 @@
+
+#include "SoundBuilder.h"
+#include "../SoundFile.internal.h"
+#include "../../util/StreamUtil.h"
+#include "../../Log.h"
+
+#include <SDL2/SDL_audio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace rob
+{
+
+    SoundBuilder::SoundBuilder()
+    {
+        m_extensions.push_back(".wav");
+        m_newExtension = ".snd";
+    }
+
+    static bool ConvertWave(const std::string &filename, std::vector<uint8_t> &samples)
+    {
+        SDL_AudioSpec spec;
+        Uint8 *buffer = nullptr;
+        Uint32 length = 0;
+        if (::SDL_LoadWAV(filename.c_str(), &spec, &buffer, &length) == nullptr)
+        {
+            log::Error("SoundBuilder: Could not load ", filename.c_str(), ": ", ::SDL_GetError());
+            return false;
+        }
+
+        SDL_AudioCVT cvt;
+        const int result = ::SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                                               AUDIO_S16SYS, SoundBuilder::CHANNELS, SoundBuilder::FREQUENCY);
+        if (result < 0)
+        {
+            log::Error("SoundBuilder: Unsupported format in ", filename.c_str(), ": ", ::SDL_GetError());
+            ::SDL_FreeWAV(buffer);
+            return false;
+        }
+
+        // The conversion is done in place and may need a larger buffer.
+        samples.resize(length * (cvt.needed ? cvt.len_mult : 1));
+        std::copy(buffer, buffer + length, samples.begin());
+        ::SDL_FreeWAV(buffer);
+
+        if (cvt.needed)
+        {
+            cvt.buf = samples.data();
+            cvt.len = length;
+            if (::SDL_ConvertAudio(&cvt) < 0)
+            {
+                log::Error("SoundBuilder: Could not convert ", filename.c_str(), ": ", ::SDL_GetError());
+                return false;
+            }
+            length = cvt.len_cvt;
+        }
+        samples.resize(length);
+        return true;
+    }
+
+    bool SoundBuilder::Build(const std::string &directory, const std::string &filename,
+                             const std::string &destDirectory, const std::string &destFilename)
+    {
+        std::vector<uint8_t> samples;
+        if (!ConvertWave(filename, samples))
+            return false;
+
+        SoundFileHeader header;
+        header.magic = SoundFileHeader::MAGIC;
+        header.version = SoundFileHeader::VERSION;
+        header.frequency = FREQUENCY;
+        header.channels = CHANNELS;
+        header.bits_per_sample = BITS_PER_SAMPLE;
+        header.data_offset = (sizeof(header) + SOUND_FILE_DATA_ALIGN - 1) & ~(SOUND_FILE_DATA_ALIGN - 1);
+        header.data_size = samples.size();
+
+        std::ofstream out(destFilename.c_str(), std::ios_base::binary);
+        if (!out.is_open())
+        {
+            log::Error("SoundBuilder: Could not open the destination file ", destFilename.c_str());
+            return false;
+        }
+
+        WriteValue(out, header);
+        for (uint32_t i = sizeof(header); i < header.data_offset; i++)
+            out.put('\0');
+        out.write(reinterpret_cast<const char*>(samples.data()), samples.size());
+        return bool(out);
+    }
+
+} // rob
@@ -0,0 +1,28 @@
+
+#ifndef H_ROB_SOUND_BUILDER_H
+#define H_ROB_SOUND_BUILDER_H
+
+#include "ResourceBuilder.h"
+
+namespace rob
+{
+
+    /// Converts wave files to 16 bit mono PCM at the output frequency and
+    /// writes them in the format of SoundFile.internal.h, so the samples can
+    /// be given to the audio device without decoding.
+    class SoundBuilder : public ResourceBuilder
+    {
+    public:
+        static const int FREQUENCY = 44100;
+        static const int CHANNELS = 1;
+        static const int BITS_PER_SAMPLE = 16;
+
+    public:
+        SoundBuilder();
+        bool Build(const std::string &directory, const std::string &filename,
+                   const std::string &destDirectory, const std::string &destFilename) override;
+    };
+
+} // rob
+
+#endif // H_ROB_SOUND_BUILDER_H
@@ -0,0 +1,103 @@
+
+#include "FramePacer.h"
+#include "Time.h"
+
+#include "../Log.h"
+
+namespace rob
+{
+
+    static const uint32_t DEFAULT_TARGET_FPS = 120;
+    static const uint32_t DEFAULT_IDLE_FPS = 30;
+
+    // The initial and minimum time spent spinning before the deadline.
+    static const Time_t MIN_SLEEP_MARGIN = 1000;
+    static const Time_t MAX_SLEEP_MARGIN = 4000;
+
+    FramePacer::FramePacer()
+        : m_ticker()
+        , m_targetFps(DEFAULT_TARGET_FPS)
+        , m_idleFps(DEFAULT_IDLE_FPS)
+        , m_idle(false)
+        , m_deadline(0)
+        , m_sleepMargin(MIN_SLEEP_MARGIN)
+        , m_lastSlack(0)
+        , m_totalSlack(0)
+        , m_missedDeadlines(0)
+        , m_frameCount(0)
+    {
+        m_ticker.Init();
+        m_deadline = m_ticker.GetTicks();
+    }
+
+    void FramePacer::SetTargetFps(uint32_t fps)
+    { m_targetFps = fps; }
+
+    void FramePacer::SetIdleFps(uint32_t fps)
+    { m_idleFps = fps; }
+
+    void FramePacer::SetIdle(bool idle)
+    { m_idle = idle; }
+
+    Time_t FramePacer::GetFramePeriod() const
+    {
+        const uint32_t fps = m_idle ? m_idleFps : m_targetFps;
+        return (fps == 0) ? 0 : 1000000ULL / fps;
+    }
+
+    void FramePacer::WaitForNextFrame()
+    {
+        m_frameCount++;
+
+        const Time_t period = GetFramePeriod();
+        Time_t now = m_ticker.GetTicks();
+        m_deadline += period;
+
+        if (period == 0 || now >= m_deadline)
+        {
+            if (period != 0)
+                m_missedDeadlines++;
+            m_lastSlack = 0;
+            // Start pacing again from the current time instead of trying
+            // to catch up with the missed frames.
+            m_deadline = now;
+            return;
+        }
+
+        m_lastSlack = m_deadline - now;
+        m_totalSlack += m_lastSlack;
+
+        if (m_lastSlack > m_sleepMargin)
+        {
+            const Time_t sleepTime = m_lastSlack - m_sleepMargin;
+            Delay(uint32_t(sleepTime / 1000));
+
+            // Adapt the margin to the observed oversleeping of the OS timer.
+            const Time_t after = m_ticker.GetTicks();
+            const Time_t slept = after - now;
+            const Time_t requested = (sleepTime / 1000) * 1000;
+            if (slept > requested)
+            {
+                const Time_t oversleep = slept - requested;
+                m_sleepMargin = (m_sleepMargin * 7 + oversleep) / 8;
+                if (oversleep > m_sleepMargin) m_sleepMargin = oversleep;
+            }
+            if (m_sleepMargin < MIN_SLEEP_MARGIN) m_sleepMargin = MIN_SLEEP_MARGIN;
+            if (m_sleepMargin > MAX_SLEEP_MARGIN) m_sleepMargin = MAX_SLEEP_MARGIN;
+            now = after;
+        }
+
+        while (now < m_deadline)
+            now = m_ticker.GetTicks();
+    }
+
+    void FramePacer::Report() const
+    {
+        const Time_t avgSlack = (m_frameCount > 0) ? m_totalSlack / m_frameCount : 0;
+        log::Info("Frame pacing: target ", m_targetFps, " fps, idle ", m_idleFps, " fps");
+        log::Info("  frames: ", m_frameCount, ", missed deadlines: ", m_missedDeadlines);
+        log::Info("  last slack: ", m_lastSlack, " us, average slack: ", avgSlack,
+                  " us, sleep margin: ", m_sleepMargin, " us");
+    }
+
+} // rob
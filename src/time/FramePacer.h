@@ -0,0 +1,61 @@
+
+#ifndef H_ROB_FRAME_PACER_H
+#define H_ROB_FRAME_PACER_H
+
+#include "MicroTicker.h"
+
+namespace rob
+{
+
+    /// Paces frames to a target frame rate. Sleeps for the most of the time
+    /// left until the frame deadline and spins the rest, so that the OS can
+    /// use the core while keeping the pacing accurate.
+    class FramePacer
+    {
+    public:
+        FramePacer();
+
+        /// Sets the target frame rate. Zero disables the frame limiter.
+        void SetTargetFps(uint32_t fps);
+        uint32_t GetTargetFps() const { return m_targetFps; }
+
+        /// Sets the frame rate used while idle (e.g. menus and paused game).
+        void SetIdleFps(uint32_t fps);
+        uint32_t GetIdleFps() const { return m_idleFps; }
+
+        void SetIdle(bool idle);
+        bool IsIdle() const { return m_idle; }
+
+        /// Waits until the deadline of the current frame.
+        void WaitForNextFrame();
+
+        /// Returns the time that was left until the deadline of the last frame.
+        Time_t GetLastSlack() const { return m_lastSlack; }
+        /// Returns the number of frames that did not make their deadline.
+        uint32_t GetMissedDeadlines() const { return m_missedDeadlines; }
+        uint32_t GetFrameCount() const { return m_frameCount; }
+
+        /// Logs the frame pacing statistics.
+        void Report() const;
+
+    private:
+        Time_t GetFramePeriod() const;
+
+    private:
+        MicroTicker m_ticker;
+        uint32_t m_targetFps;
+        uint32_t m_idleFps;
+        bool m_idle;
+
+        Time_t m_deadline;
+        Time_t m_sleepMargin;
+
+        Time_t m_lastSlack;
+        Time_t m_totalSlack;
+        uint32_t m_missedDeadlines;
+        uint32_t m_frameCount;
+    };
+
+} // rob
+
+#endif // H_ROB_FRAME_PACER_H
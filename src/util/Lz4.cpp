@@ -0,0 +1,184 @@
+
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace rob
+{
+
+    static const size_t_32 MIN_MATCH = 4;
+    // The last match must start at least 12 bytes before the end of the block
+    // and the last 5 bytes are always literals.
+    static const size_t_32 MF_LIMIT = 12;
+    static const size_t_32 LAST_LITERALS = 5;
+    static const size_t_32 MAX_OFFSET = 65535;
+    static const size_t_32 HASH_BITS = 12;
+
+    static inline uint32_t Read32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static inline uint32_t Hash(uint32_t value)
+    { return (value * 2654435761u) >> (32 - HASH_BITS); }
+
+    static inline bool WriteLength(uint8_t *&out, const uint8_t *outEnd, size_t_32 length)
+    {
+        while (length >= 255)
+        {
+            if (out >= outEnd) return false;
+            *out++ = 255;
+            length -= 255;
+        }
+        if (out >= outEnd) return false;
+        *out++ = uint8_t(length);
+        return true;
+    }
+
+    static bool WriteSequence(uint8_t *&out, const uint8_t *outEnd,
+                              const uint8_t *literals, size_t_32 literalCount,
+                              size_t_32 offset, size_t_32 matchLength)
+    {
+        if (out >= outEnd) return false;
+        uint8_t *token = out++;
+        *token = uint8_t((literalCount >= 15 ? 15 : literalCount) << 4);
+        if (literalCount >= 15 && !WriteLength(out, outEnd, literalCount - 15))
+            return false;
+
+        if (size_t_32(outEnd - out) < literalCount)
+            return false;
+        std::memcpy(out, literals, literalCount);
+        out += literalCount;
+
+        if (matchLength == 0)
+            return true;
+
+        if (outEnd - out < 2) return false;
+        *out++ = uint8_t(offset);
+        *out++ = uint8_t(offset >> 8);
+
+        const size_t_32 length = matchLength - MIN_MATCH;
+        *token |= uint8_t(length >= 15 ? 15 : length);
+        if (length >= 15 && !WriteLength(out, outEnd, length - 15))
+            return false;
+        return true;
+    }
+
+    size_t_32 Lz4CompressBound(size_t_32 size)
+    { return size + size / 255 + 16; }
+
+    size_t_32 Lz4Compress(const uint8_t *src, size_t_32 srcSize, uint8_t *dest, size_t_32 destCapacity)
+    {
+        uint8_t *out = dest;
+        const uint8_t * const outEnd = dest + destCapacity;
+
+        const uint8_t *anchor = src;
+        const uint8_t * const end = src + srcSize;
+
+        if (srcSize > MF_LIMIT)
+        {
+            uint32_t table[1 << HASH_BITS];
+            for (size_t_32 i = 0; i < (1 << HASH_BITS); i++)
+                table[i] = uint32_t(-1);
+
+            const uint8_t * const matchLimit = end - MF_LIMIT;
+            const uint8_t * const matchEnd = end - LAST_LITERALS;
+            const uint8_t *ip = src;
+            while (ip < matchLimit)
+            {
+                const uint32_t sequence = Read32(ip);
+                const uint32_t h = Hash(sequence);
+                const uint32_t candidate = table[h];
+                const uint32_t pos = uint32_t(ip - src);
+                table[h] = pos;
+
+                if (candidate == uint32_t(-1) || pos - candidate > MAX_OFFSET
+                    || Read32(src + candidate) != sequence)
+                {
+                    ip++;
+                    continue;
+                }
+
+                const uint8_t *match = src + candidate;
+                size_t_32 length = MIN_MATCH;
+                while (ip + length < matchEnd && ip[length] == match[length])
+                    length++;
+
+                if (!WriteSequence(out, outEnd, anchor, ip - anchor, pos - candidate, length))
+                    return 0;
+
+                ip += length;
+                anchor = ip;
+            }
+        }
+
+        if (!WriteSequence(out, outEnd, anchor, end - anchor, 0, 0))
+            return 0;
+        return out - dest;
+    }
+
+    bool Lz4Decompress(const uint8_t *src, size_t_32 srcSize, uint8_t *dest, size_t_32 destSize)
+    {
+        const uint8_t *ip = src;
+        const uint8_t * const ipEnd = src + srcSize;
+        uint8_t *op = dest;
+        uint8_t * const opEnd = dest + destSize;
+
+        while (ip < ipEnd)
+        {
+            const uint8_t token = *ip++;
+
+            size_t_32 literalCount = token >> 4;
+            if (literalCount == 15)
+            {
+                uint8_t b;
+                do
+                {
+                    if (ip >= ipEnd) return false;
+                    b = *ip++;
+                    literalCount += b;
+                } while (b == 255);
+            }
+            if (size_t_32(ipEnd - ip) < literalCount || size_t_32(opEnd - op) < literalCount)
+                return false;
+            std::memcpy(op, ip, literalCount);
+            ip += literalCount;
+            op += literalCount;
+
+            // The last sequence has only literals.
+            if (ip == ipEnd)
+                break;
+
+            if (ipEnd - ip < 2) return false;
+            const size_t_32 offset = ip[0] | (size_t_32(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > size_t_32(op - dest))
+                return false;
+
+            size_t_32 length = token & 15;
+            if (length == 15)
+            {
+                uint8_t b;
+                do
+                {
+                    if (ip >= ipEnd) return false;
+                    b = *ip++;
+                    length += b;
+                } while (b == 255);
+            }
+            length += MIN_MATCH;
+            if (size_t_32(opEnd - op) < length)
+                return false;
+
+            // The match can overlap the output, so copy byte by byte.
+            const uint8_t *match = op - offset;
+            for (size_t_32 i = 0; i < length; i++)
+                op[i] = match[i];
+            op += length;
+        }
+        return op == opEnd;
+    }
+
+} // rob
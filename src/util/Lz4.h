@@ -0,0 +1,23 @@
+
+#ifndef H_ROB_LZ4_H
+#define H_ROB_LZ4_H
+
+#include "../Types.h"
+
+namespace rob
+{
+
+    /// Returns the maximum size of the compressed data for input of the given size.
+    size_t_32 Lz4CompressBound(size_t_32 size);
+
+    /// Compresses data to the LZ4 block format. Returns the compressed size
+    /// or zero, if the compressed data does not fit to the destination.
+    size_t_32 Lz4Compress(const uint8_t *src, size_t_32 srcSize, uint8_t *dest, size_t_32 destCapacity);
+
+    /// Decompresses a LZ4 block. Returns false, if the input is malformed or
+    /// does not decompress to exactly destSize bytes.
+    bool Lz4Decompress(const uint8_t *src, size_t_32 srcSize, uint8_t *dest, size_t_32 destSize);
+
+} // rob
+
+#endif // H_ROB_LZ4_H
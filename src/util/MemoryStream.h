@@ -0,0 +1,57 @@
+
+#ifndef H_ROB_MEMORY_STREAM_H
+#define H_ROB_MEMORY_STREAM_H
+
+#include "../Types.h"
+
+#include <istream>
+#include <streambuf>
+
+namespace rob
+{
+
+    /// Read only stream buffer over memory owned by someone else.
+    class MemoryStreamBuf : public std::streambuf
+    {
+    public:
+        MemoryStreamBuf(const void *data, size_t_32 size)
+        {
+            char *begin = const_cast<char*>(static_cast<const char*>(data));
+            setg(begin, begin, begin + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                         std::ios_base::openmode which = std::ios_base::in) override
+        {
+            char *pos = gptr();
+            if (dir == std::ios_base::beg) pos = eback() + off;
+            else if (dir == std::ios_base::cur) pos = gptr() + off;
+            else if (dir == std::ios_base::end) pos = egptr() + off;
+
+            if (pos < eback() || pos > egptr())
+                return pos_type(off_type(-1));
+            setg(eback(), pos, egptr());
+            return pos_type(pos - eback());
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override
+        { return seekoff(off_type(pos), std::ios_base::beg, which); }
+    };
+
+    /// Input stream reading from memory without copying it.
+    class MemoryStream : public std::istream
+    {
+    public:
+        MemoryStream(const void *data, size_t_32 size)
+            : std::istream(nullptr)
+            , m_buffer(data, size)
+        { rdbuf(&m_buffer); }
+
+    private:
+        MemoryStreamBuf m_buffer;
+    };
+
+} // rob
+
+#endif // H_ROB_MEMORY_STREAM_H
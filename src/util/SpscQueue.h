@@ -0,0 +1,74 @@
+
+#ifndef H_ROB_SPSC_QUEUE_H
+#define H_ROB_SPSC_QUEUE_H
+
+#include "../Types.h"
+
+#include <atomic>
+
+namespace rob
+{
+
+    /// Fixed size lock-free queue for one producer and one consumer thread.
+    /// The indices run freely and are masked, so the capacity must be a
+    /// power of two.
+    template <class T, uint32_t Capacity>
+    class SpscQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+        static const size_t_32 CACHE_LINE_SIZE = 64;
+
+    public:
+        SpscQueue()
+            : m_head(0)
+            , m_tailCache(0)
+            , m_tail(0)
+            , m_headCache(0)
+        { }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator = (const SpscQueue&) = delete;
+
+        /// Called by the producer. Returns false, if the queue is full.
+        bool Push(const T &value)
+        {
+            const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_headCache == Capacity)
+            {
+                m_headCache = m_head.load(std::memory_order_acquire);
+                if (tail - m_headCache == Capacity)
+                    return false;
+            }
+            m_items[tail & (Capacity - 1)] = value;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Called by the consumer. Returns false, if the queue is empty.
+        bool Pop(T &value)
+        {
+            const uint32_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tailCache)
+            {
+                m_tailCache = m_tail.load(std::memory_order_acquire);
+                if (head == m_tailCache)
+                    return false;
+            }
+            value = m_items[head & (Capacity - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        // The consumer and producer ends are on their own cache lines.
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_head;
+        uint32_t m_tailCache;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_tail;
+        uint32_t m_headCache;
+        alignas(CACHE_LINE_SIZE) T m_items[Capacity];
+    };
+
+} // rob
+
+#endif // H_ROB_SPSC_QUEUE_H
@@ -2,7 +2,10 @@
 #ifndef H_ROB_STREAM_UTIL_H
 #define H_ROB_STREAM_UTIL_H
 
+#include "../Types.h"
+
 #include <istream>
+#include <ostream>
 
 namespace rob
 {
@@ -15,6 +18,12 @@ namespace rob
         return value;
     }
 
+    template <class T>
+    inline void WriteValue(std::ostream &file, const T value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
     template <size_t_32 N>
     inline size_t_32 ReadString(std::istream &file, char (&buffer)[N])
     {